@@ -10,6 +10,7 @@
 #include <cerrno>
 #include <typeinfo>
 #include <map>
+#include <atomic>
 
 using namespace std::literals::string_literals;
 
@@ -113,11 +114,21 @@ static fs::error to_error(DWORD e)
 	case ERROR_SHARING_VIOLATION: return fs::error::acces;
 	case ERROR_DIR_NOT_EMPTY: return fs::error::notempty;
 	case ERROR_NOT_READY: return fs::error::noent;
+	case ERROR_NOACCESS: return fs::error::fault;
 	//case ERROR_INVALID_PARAMETER: return fs::error::inval;
 	default: fmt::throw_exception("Unknown Win32 error: %u.", e);
 	}
 }
 
+// Report an inaccessible buffer before the failed I/O call throws (the caller may retry with another buffer)
+static void set_fault_error(DWORD e)
+{
+	if (e == ERROR_NOACCESS)
+	{
+		fs::g_tls_error = fs::error::fault;
+	}
+}
+
 #else
 
 #include <sys/mman.h>
@@ -153,16 +164,47 @@ static fs::error to_error(int e)
 	case EINVAL: return fs::error::inval;
 	case EACCES: return fs::error::acces;
 	case ENOTEMPTY: return fs::error::notempty;
+	case EFAULT: return fs::error::fault;
 	default: fmt::throw_exception("Unknown system error: %d.", e);
 	}
 }
 
+// Report an inaccessible buffer before the failed I/O call throws (the caller may retry with another buffer)
+static void set_fault_error(int e)
+{
+	if (e == EFAULT)
+	{
+		fs::g_tls_error = fs::error::fault;
+	}
+}
+
 #endif
 
 namespace fs
 {
 	thread_local error g_tls_error = error::ok;
 
+	static std::atomic<u64> s_create_count{0};
+
+	// Increment the create counter when the operation returns (whether it succeeded or not)
+	struct create_count_guard
+	{
+		const bool active = true;
+
+		~create_count_guard()
+		{
+			if (active)
+			{
+				s_create_count++;
+			}
+		}
+	};
+
+	u64 get_create_count()
+	{
+		return s_create_count.load();
+	}
+
 	class device_manager final
 	{
 		mutable shared_mutex m_mutex;
@@ -232,6 +274,63 @@ namespace fs
 		return this->write(buf.get(), total);
 	}
 
+	u64 file_base::read_at(u64 offset, void* buffer, u64 size)
+	{
+		const u64 old_pos = seek(0, seek_cur);
+
+		if (seek(offset, seek_set) == UINT64_MAX)
+		{
+			return 0;
+		}
+
+		const u64 result = read(buffer, size);
+		seek(old_pos, seek_set);
+		return result;
+	}
+
+	u64 file_base::write_at(u64 offset, const void* buffer, u64 size)
+	{
+		const u64 old_pos = seek(0, seek_cur);
+
+		if (seek(offset, seek_set) == UINT64_MAX)
+		{
+			return 0;
+		}
+
+		const u64 result = write(buffer, size);
+		seek(old_pos, seek_set);
+		return result;
+	}
+
+	u64 file_base::read_scatter(u64 offset, const iovec_clone* buffers, u64 buf_count)
+	{
+		u64 result = 0;
+
+		for (u64 i = 0; i < buf_count; i++)
+		{
+			const u64 nread = read_at(offset + result, const_cast<void*>(buffers[i].iov_base), buffers[i].iov_len);
+			result += nread;
+
+			if (nread < buffers[i].iov_len)
+			{
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	bool file_base::positional_io()
+	{
+		return false;
+	}
+
+	file_map file_base::map()
+	{
+		g_tls_error = error::inval;
+		return {};
+	}
+
 	dir_base::~dir_base()
 	{
 	}
@@ -513,6 +612,8 @@ bool fs::statfs(const std::string& path, fs::device_stat& info)
 
 bool fs::create_dir(const std::string& path)
 {
+	const create_count_guard guard;
+
 	if (auto device = get_virtual_device(path))
 	{
 		return device->create_dir(path);
@@ -589,6 +690,8 @@ bool fs::remove_dir(const std::string& path)
 
 bool fs::rename(const std::string& from, const std::string& to, bool overwrite)
 {
+	const create_count_guard guard;
+
 	if (from.empty() || to.empty())
 	{
 		// Don't allow opening empty path (TODO)
@@ -673,6 +776,8 @@ bool fs::rename(const std::string& from, const std::string& to, bool overwrite)
 
 bool fs::copy_file(const std::string& from, const std::string& to, bool overwrite)
 {
+	const create_count_guard guard;
+
 	const auto device = get_virtual_device(from);
 
 	if (device != get_virtual_device(to) || device) // TODO
@@ -879,6 +984,8 @@ void fs::file::xfail() const
 
 fs::file::file(const std::string& path, bs_t<open_mode> mode)
 {
+	const create_count_guard guard{static_cast<bool>(mode & fs::create)};
+
 	if (path.empty())
 	{
 		// Don't allow opening empty path (TODO)
@@ -942,15 +1049,47 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 	class windows_file final : public file_base
 	{
 		const HANDLE m_handle;
+		const DWORD m_access;
+
+		// Second handle with its own file pointer for positional I/O (created on first use)
+		std::atomic<HANDLE> m_pos_handle{nullptr};
+
+		HANDLE get_pos_handle()
+		{
+			if (const HANDLE h = m_pos_handle.load())
+			{
+				return h;
+			}
+
+			HANDLE h = ReOpenFile(m_handle, m_access & (GENERIC_READ | GENERIC_WRITE), FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0);
+
+			if (HANDLE _old = nullptr; !m_pos_handle.compare_exchange_strong(_old, h))
+			{
+				if (h != INVALID_HANDLE_VALUE)
+				{
+					CloseHandle(h);
+				}
+
+				h = m_pos_handle.load();
+			}
+
+			return h;
+		}
 
 	public:
-		windows_file(HANDLE handle)
+		windows_file(HANDLE handle, DWORD access)
 			: m_handle(handle)
+			, m_access(access)
 		{
 		}
 
 		~windows_file() override
 		{
+			if (const HANDLE h = m_pos_handle.load(); h && h != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(h);
+			}
+
 			CloseHandle(m_handle);
 		}
 
@@ -998,7 +1137,15 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 			const int size = narrow<int>(count, "file::read" HERE);
 
 			DWORD nread;
-			verify("file::read" HERE), ReadFile(m_handle, buffer, size, &nread, NULL);
+
+			const BOOL ok = ReadFile(m_handle, buffer, size, &nread, NULL);
+
+			if (!ok)
+			{
+				set_fault_error(GetLastError());
+			}
+
+			verify("file::read" HERE), ok;
 
 			return nread;
 		}
@@ -1009,7 +1156,15 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 			const int size = narrow<int>(count, "file::write" HERE);
 
 			DWORD nwritten;
-			verify("file::write" HERE), WriteFile(m_handle, buffer, size, &nwritten, NULL);
+
+			const BOOL ok = WriteFile(m_handle, buffer, size, &nwritten, NULL);
+
+			if (!ok)
+			{
+				set_fault_error(GetLastError());
+			}
+
+			verify("file::write" HERE), ok;
 
 			return nwritten;
 		}
@@ -1046,9 +1201,110 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 		{
 			return m_handle;
 		}
+
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			const HANDLE h = get_pos_handle();
+
+			if (h == INVALID_HANDLE_VALUE)
+			{
+				return file_base::read_at(offset, buffer, count);
+			}
+
+			// TODO (call ReadFile multiple times if count is too big)
+			const int size = narrow<int>(count, "file::read_at" HERE);
+
+			OVERLAPPED ovl{};
+			ovl.Offset = static_cast<DWORD>(offset);
+			ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD nread;
+
+			if (!ReadFile(h, buffer, size, &nread, &ovl))
+			{
+				const DWORD e = GetLastError();
+				set_fault_error(e);
+				verify("file::read_at" HERE), e == ERROR_HANDLE_EOF;
+				return 0;
+			}
+
+			return nread;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			const HANDLE h = m_access & GENERIC_WRITE ? get_pos_handle() : INVALID_HANDLE_VALUE;
+
+			if (h == INVALID_HANDLE_VALUE)
+			{
+				return file_base::write_at(offset, buffer, count);
+			}
+
+			// TODO (call WriteFile multiple times if count is too big)
+			const int size = narrow<int>(count, "file::write_at" HERE);
+
+			OVERLAPPED ovl{};
+			ovl.Offset = static_cast<DWORD>(offset);
+			ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD nwritten;
+
+			const BOOL ok = WriteFile(h, buffer, size, &nwritten, &ovl);
+
+			if (!ok)
+			{
+				set_fault_error(GetLastError());
+			}
+
+			verify("file::write_at" HERE), ok;
+
+			return nwritten;
+		}
+
+		bool positional_io() override
+		{
+			// Falls back to the default implementation if the second handle is unavailable
+			return get_pos_handle() != INVALID_HANDLE_VALUE;
+		}
+
+		file_map map() override
+		{
+			const u64 _size = size();
+
+			if (!_size)
+			{
+				g_tls_error = error::inval;
+				return {};
+			}
+
+			const HANDLE mapping = CreateFileMappingW(m_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+			if (!mapping)
+			{
+				g_tls_error = to_error(GetLastError());
+				return {};
+			}
+
+			const void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+			if (!ptr)
+			{
+				g_tls_error = to_error(GetLastError());
+			}
+
+			// The view keeps the mapping object alive
+			CloseHandle(mapping);
+
+			if (!ptr)
+			{
+				return {};
+			}
+
+			return file_map(std::shared_ptr<const void>(ptr, [](const void* p) { UnmapViewOfFile(p); }), _size);
+		}
 	};
 
-	m_file = std::make_unique<windows_file>(handle);
+	m_file = std::make_unique<windows_file>(handle, access);
 #else
 	int flags = 0;
 
@@ -1142,6 +1398,12 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 		u64 read(void* buffer, u64 count) override
 		{
 			const auto result = ::read(m_fd, buffer, count);
+
+			if (result == -1)
+			{
+				set_fault_error(errno);
+			}
+
 			verify("file::read" HERE), result != -1;
 
 			return result;
@@ -1150,6 +1412,12 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 		u64 write(const void* buffer, u64 count) override
 		{
 			const auto result = ::write(m_fd, buffer, count);
+
+			if (result == -1)
+			{
+				set_fault_error(errno);
+			}
+
 			verify("file::write" HERE), result != -1;
 
 			return result;
@@ -1197,6 +1465,68 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 
 			return result;
 		}
+
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			const auto result = ::pread(m_fd, buffer, count, offset);
+
+			if (result == -1)
+			{
+				set_fault_error(errno);
+			}
+
+			verify("file::read_at" HERE), result != -1;
+
+			return result;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			const auto result = ::pwrite(m_fd, buffer, count, offset);
+
+			if (result == -1)
+			{
+				set_fault_error(errno);
+			}
+
+			verify("file::write_at" HERE), result != -1;
+
+			return result;
+		}
+
+		u64 read_scatter(u64 offset, const iovec_clone* buffers, u64 buf_count) override
+		{
+			const auto result = ::preadv(m_fd, (const iovec*)buffers, buf_count, offset);
+			verify("file::read_scatter" HERE), result != -1;
+
+			return result;
+		}
+
+		bool positional_io() override
+		{
+			return true;
+		}
+
+		file_map map() override
+		{
+			const u64 _size = size();
+
+			if (!_size)
+			{
+				g_tls_error = error::inval;
+				return {};
+			}
+
+			void* const ptr = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, m_fd, 0);
+
+			if (ptr == MAP_FAILED)
+			{
+				g_tls_error = to_error(errno);
+				return {};
+			}
+
+			return file_map(std::shared_ptr<const void>(ptr, [_size](const void* p) { ::munmap(const_cast<void*>(p), _size); }), _size);
+		}
 	};
 
 	m_file = std::make_unique<unix_file>(fd);
@@ -1267,6 +1597,34 @@ fs::file::file(const void* ptr, std::size_t size)
 		{
 			return m_size;
 		}
+
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			if (offset < m_size)
+			{
+				const u64 result = std::min<u64>(count, m_size - offset);
+				std::memcpy(buffer, m_ptr + offset, result);
+				return result;
+			}
+
+			return 0;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			return 0;
+		}
+
+		bool positional_io() override
+		{
+			return true;
+		}
+
+		file_map map() override
+		{
+			// Memory is owned by the caller
+			return file_map(std::shared_ptr<const void>(m_ptr, [](const void*) {}), m_size);
+		}
 	};
 
 	m_file = std::make_unique<memory_stream>(ptr, size);
@@ -1651,28 +2009,35 @@ fs::file fs::make_gather(std::vector<fs::file> files)
 
 		u64 read(void* buffer, u64 size) override
 		{
-			if (pos < end)
+			const u64 result = read_at(pos, buffer, size);
+			pos += result;
+			return result;
+		}
+
+		u64 read_at(u64 offset, void* buffer, u64 size) override
+		{
+			if (offset < end)
 			{
 				// Current pos
-				const u64 start = pos;
+				const u64 start = offset;
 
 				// Get readable size
-				if (const u64 max = std::min<u64>(size, end - pos))
+				if (const u64 max = std::min<u64>(size, end - offset))
 				{
 					u8* buf_out = static_cast<u8*>(buffer);
 					u64 buf_max = max;
 
-					for (auto it = ends.upper_bound(pos); it != ends.end(); ++it)
+					for (auto it = ends.upper_bound(offset); it != ends.end(); ++it)
 					{
-						// Set position for the fragment
-						files[it->second].seek(pos - it->first, fs::seek_end);
+						// Position in the fragment
+						const u64 frag_start = it == ends.begin() ? 0 : std::prev(it)->first;
 
-						const u64 count = std::min<u64>(it->first - pos, buf_max);
-						const u64 read  = files[it->second].read(buf_out, count);
+						const u64 count = std::min<u64>(it->first - offset, buf_max);
+						const u64 read  = files[it->second].read_at(offset - frag_start, buf_out, count);
 
 						buf_out += count;
 						buf_max -= count;
-						pos     += read;
+						offset  += read;
 
 						if (read < count || buf_max == 0)
 						{
@@ -1680,7 +2045,7 @@ fs::file fs::make_gather(std::vector<fs::file> files)
 						}
 					}
 
-					return pos - start;
+					return offset - start;
 				}
 			}
 
@@ -1692,6 +2057,16 @@ fs::file fs::make_gather(std::vector<fs::file> files)
 			return 0;
 		}
 
+		u64 write_at(u64 offset, const void* buffer, u64 size) override
+		{
+			return 0;
+		}
+
+		bool positional_io() override
+		{
+			return std::all_of(files.begin(), files.end(), [](const fs::file& f) { return f.positional_io(); });
+		}
+
 		u64 seek(s64 offset, seek_mode whence) override
 		{
 			const s64 new_pos =
@@ -1751,6 +2126,7 @@ void fmt_class_string<fs::error>::format(std::string& out, u64 arg)
 		case fs::error::exist: return "Already exists";
 		case fs::error::acces: return "Access violation";
 		case fs::error::notempty: return "Not empty";
+		case fs::error::fault: return "Bad address";
 		}
 
 		return unknown;
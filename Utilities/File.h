@@ -72,6 +72,44 @@ namespace fs
 		std::size_t iov_len;
 	};
 
+	// Read-only memory mapping of the file contents (keeps the mapping alive)
+	class file_map
+	{
+		std::shared_ptr<const void> m_ptr;
+		u64 m_size = 0;
+
+	public:
+		file_map() = default;
+
+		file_map(std::shared_ptr<const void> ptr, u64 size)
+			: m_ptr(std::move(ptr))
+			, m_size(size)
+		{
+		}
+
+		// Make a subrange sharing the ownership of the mapping
+		file_map(const file_map& base, u64 offset, u64 size)
+			: m_ptr(base.m_ptr, base.data() + std::min(offset, base.m_size))
+			, m_size(std::min(size, base.m_size - std::min(offset, base.m_size)))
+		{
+		}
+
+		explicit operator bool() const
+		{
+			return m_ptr.operator bool();
+		}
+
+		const uchar* data() const
+		{
+			return static_cast<const uchar*>(m_ptr.get());
+		}
+
+		u64 size() const
+		{
+			return m_size;
+		}
+	};
+
 	// File handle base
 	struct file_base
 	{
@@ -86,6 +124,19 @@ namespace fs
 		virtual u64 size() = 0;
 		virtual native_handle get_handle();
 		virtual u64 write_gather(const iovec_clone* buffers, u64 buf_count);
+
+		// Positional I/O, doesn't change the current position
+		// The default implementation seeks, reads or writes and seeks back, which is not atomic: unless positional_io() returns true,
+		// the caller must serialize it with all other I/O on the same file (for lv2 files, hold lv2_file::lock_positional_io())
+		virtual u64 read_at(u64 offset, void* buffer, u64 size);
+		virtual u64 write_at(u64 offset, const void* buffer, u64 size);
+		virtual u64 read_scatter(u64 offset, const iovec_clone* buffers, u64 buf_count);
+
+		// Check whether positional I/O is safe to use concurrently with other I/O (false for the default implementation)
+		virtual bool positional_io();
+
+		// Map the file for reading (returns empty object if not supported)
+		virtual file_map map();
 	};
 
 	// Directory entry (TODO)
@@ -377,6 +428,48 @@ namespace fs
 			return m_file->write_gather(buffers, buf_count);
 		}
 
+		// Read the data at the specified offset without changing the current position
+		u64 read_at(u64 offset, void* buffer, u64 count) const
+		{
+			if (!m_file) xnull();
+			return m_file->read_at(offset, buffer, count);
+		}
+
+		// Write the data at the specified offset without changing the current position
+		u64 write_at(u64 offset, const void* buffer, u64 count) const
+		{
+			if (!m_file) xnull();
+			return m_file->write_at(offset, buffer, count);
+		}
+
+		// Read POD at the specified offset, sizeof(T) is used
+		template<typename T>
+		std::enable_if_t<std::is_pod<T>::value && !std::is_pointer<T>::value, bool> read_at(u64 offset, T& data) const
+		{
+			return read_at(offset, &data, sizeof(T)) == sizeof(T);
+		}
+
+		// Scattered read at the specified offset (iov_base must be writable)
+		u64 read_scatter(u64 offset, const iovec_clone* buffers, u64 buf_count) const
+		{
+			if (!m_file) xnull();
+			return m_file->read_scatter(offset, buffers, buf_count);
+		}
+
+		// Check whether read_at/write_at don't use the current position (otherwise the caller must serialize all I/O on the file)
+		bool positional_io() const
+		{
+			if (!m_file) xnull();
+			return m_file->positional_io();
+		}
+
+		// Map the whole file for reading, the mapping may outlive the file object
+		file_map map() const
+		{
+			if (!m_file) xnull();
+			return m_file->map();
+		}
+
 #ifdef _WIN32
 		// Windows-specific function
 		bool set_delete(bool autodelete = true) const;
@@ -517,11 +610,16 @@ namespace fs
 		exist,
 		acces,
 		notempty,
+		fault,
 	};
 
 	// Error code returned
 	extern thread_local error g_tls_error;
 
+	// Get the number of finished calls that could have created a path (create_dir, rename, copy_file, opening with create)
+	// Caches of nonexistent paths are only valid while it stays the same (read it before the lookup)
+	u64 get_create_count();
+
 	template <typename T>
 	struct container_stream final : file_base
 	{
@@ -13,6 +13,8 @@
 #include <thread>
 #include <chrono>
 #include <cstring>
+#include <algorithm>
+#include <memory>
 
 using namespace std::literals::chrono_literals;
 
@@ -118,20 +120,60 @@ namespace logs
 		std::string text;
 	};
 
+	// Messages deferred by one thread (written by this thread, read by the formatter thread)
+	struct deferred_ring
+	{
+		static constexpr u64 size = 256 * 1024;
+
+		alignas(128) atomic_t<u64> push{0}; // Total bytes written
+		alignas(128) atomic_t<u64> pop{0}; // Total bytes processed
+		atomic_t<bool> orphan{false}; // Set on thread exit
+
+		const std::unique_ptr<u64[]> data{new u64[size / 8]};
+	};
+
+	// Deferred message header, followed by raw arguments, prefix and copied strings (or formatted text)
+	struct deferred_record
+	{
+		u32 size; // Total size (multiple of 8)
+		u32 argc; // UINT32_MAX: padding before the end of the ring
+		u64 stamp;
+		const message* msg;
+		const char* fmt; // Null if the text is already formatted
+		const fmt_type_info* sup;
+		u32 prefix_size;
+		u32 data_size;
+	};
+
 	struct file_listener : public file_writer, public listener
 	{
 		file_listener(const std::string& name);
 
-		virtual ~file_listener() = default;
+		virtual ~file_listener();
 
 		// Encode level, current thread name, channel name and write log message
 		virtual void log(u64 stamp, const message& msg, const std::string& prefix, const std::string& text) override;
 
+		// Put message in the current thread's ring (returns false if the message must be sent immediately)
+		bool defer(u64 stamp, const message& msg, const char* fmt, const fmt_type_info* sup, const std::vector<u64>& args);
+
+		// Formatter thread: format deferred messages and send them to all listeners
+		void format_deferred();
+
+		void set_deferred(bool enabled);
+
 		// Channel registry
 		std::unordered_map<std::string, channel_info> channels;
 
 		// Messages for delayed listener initialization
 		std::vector<stored_message> messages;
+
+		// Deferred formatting state
+		atomic_t<bool> deferred{false};
+		atomic_t<bool> formatter_stop{false};
+		std::thread formatter;
+		shared_mutex rings_mutex;
+		std::vector<std::shared_ptr<deferred_ring>> rings;
 	};
 
 	static file_listener* get_logger()
@@ -205,6 +247,11 @@ namespace logs
 		get_logger()->channels[ch_name].set_level(value);
 	}
 
+	void set_deferred(bool enabled)
+	{
+		get_logger()->set_deferred(enabled);
+	}
+
 	// Must be called in main() to stop accumulating messages in g_messages
 	void set_init()
 	{
@@ -286,6 +333,13 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, ...) co
 	for (u64& arg : args)
 		arg = va_arg(c_args, u64);
 	va_end(c_args);
+
+	// Leave formatting to the formatter thread if enabled
+	if (get_logger()->deferred && g_init && get_logger()->defer(stamp, *this, fmt, sup, args))
+	{
+		return;
+	}
+
 	fmt::raw_append(text, fmt, sup, args.data());
 	std::string prefix = g_tls_log_prefix();
 
@@ -662,3 +716,317 @@ void logs::file_listener::log(u64 stamp, const logs::message& msg, const std::st
 
 	file_writer::log(msg.sev, text.data(), text.size());
 }
+
+// Set for the formatter thread
+static thread_local bool s_tls_formatter = false;
+
+logs::file_listener::~file_listener()
+{
+	if (formatter.joinable())
+	{
+		// Process remaining messages
+		deferred = false;
+		formatter_stop = true;
+		formatter.join();
+	}
+}
+
+void logs::file_listener::set_deferred(bool enabled)
+{
+	if (enabled && !formatter.joinable())
+	{
+		std::lock_guard lock(rings_mutex);
+
+		if (!formatter.joinable())
+		{
+			formatter = std::thread([this] { format_deferred(); });
+		}
+	}
+
+	deferred = enabled;
+}
+
+bool logs::file_listener::defer(u64 stamp, const message& msg, const char* fmt, const fmt_type_info* sup, const std::vector<u64>& args)
+{
+	if (s_tls_formatter)
+	{
+		return false;
+	}
+
+	// Ring owner (marks the ring on thread exit)
+	thread_local struct ring_owner
+	{
+		std::shared_ptr<deferred_ring> ptr;
+
+		~ring_owner()
+		{
+			if (ptr)
+			{
+				ptr->orphan = true;
+			}
+		}
+	} owner;
+
+	if (!owner.ptr)
+	{
+		owner.ptr = std::make_shared<deferred_ring>();
+
+		std::lock_guard lock(rings_mutex);
+		rings.emplace_back(owner.ptr);
+	}
+
+	deferred_ring& ring = *owner.ptr;
+
+	// Copy strings (replaced with their size), format immediately if other arguments are passed by reference
+	thread_local std::string data;
+	thread_local std::vector<u64> values;
+
+	data.clear();
+	values = args;
+
+	for (std::size_t i = 0; i < args.size(); i++)
+	{
+		switch (sup[i].storage)
+		{
+		case fmt_type_info::by_value:
+		{
+			break;
+		}
+		case fmt_type_info::c_string:
+		{
+			if (args[i])
+			{
+				const std::size_t old_size = data.size();
+				data += reinterpret_cast<const char*>(args[i]);
+				values[i] = data.size() - old_size;
+			}
+			else
+			{
+				values[i] = UINT64_MAX;
+			}
+
+			break;
+		}
+		case fmt_type_info::std_string:
+		{
+			data += *reinterpret_cast<const std::string*>(args[i]);
+			values[i] = reinterpret_cast<const std::string*>(args[i])->size();
+			break;
+		}
+		default:
+		{
+			data.clear();
+			fmt::raw_append(data, fmt, sup, args.data());
+			fmt = nullptr;
+			break;
+		}
+		}
+
+		if (!fmt)
+		{
+			break;
+		}
+	}
+
+	const std::string prefix = g_tls_log_prefix();
+
+	const u32 argc = fmt ? ::size32(args) : 0;
+	const u64 size = ::align(sizeof(deferred_record) + argc * sizeof(u64) + prefix.size() + data.size(), 8);
+
+	if (size > deferred_ring::size / 4)
+	{
+		// Too big: wait for the previous messages and send it immediately
+		while (ring.pop < ring.push)
+		{
+			std::this_thread::yield();
+		}
+
+		return false;
+	}
+
+	// Add padding if the record doesn't fit before the end of the ring
+	const u64 pos = ring.push;
+	const u64 offset = pos % deferred_ring::size;
+	const u64 pad = deferred_ring::size - offset < size ? deferred_ring::size - offset : 0;
+
+	while (pos + pad + size - ring.pop > deferred_ring::size)
+	{
+		// Wait for the formatter thread
+		std::this_thread::yield();
+	}
+
+	uchar* const base = reinterpret_cast<uchar*>(ring.data.get());
+
+	if (pad)
+	{
+		reinterpret_cast<u32*>(base + offset)[0] = static_cast<u32>(pad);
+		reinterpret_cast<u32*>(base + offset)[1] = UINT32_MAX;
+	}
+
+	uchar* ptr = base + (pos + pad) % deferred_ring::size;
+
+	deferred_record& rec = *reinterpret_cast<deferred_record*>(ptr);
+	rec.size = static_cast<u32>(size);
+	rec.argc = argc;
+	rec.stamp = stamp;
+	rec.msg = &msg;
+	rec.fmt = fmt;
+	rec.sup = sup;
+	rec.prefix_size = ::size32(prefix);
+	rec.data_size = ::size32(data);
+	ptr += sizeof(deferred_record);
+
+	if (argc)
+	{
+		std::memcpy(ptr, values.data(), argc * sizeof(u64));
+		ptr += argc * sizeof(u64);
+	}
+
+	std::memcpy(ptr, prefix.data(), prefix.size());
+	std::memcpy(ptr + prefix.size(), data.data(), data.size());
+
+	ring.push.release(pos + pad + size);
+
+	if (msg.sev <= level::error)
+	{
+		// Make sure errors are written before continuing (in case of crash)
+		while (ring.pop < pos + pad + size)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	return true;
+}
+
+void logs::file_listener::format_deferred()
+{
+	s_tls_formatter = true;
+
+	std::vector<std::shared_ptr<deferred_ring>> active;
+	std::vector<u64> ends;
+	std::vector<const deferred_record*> batch;
+
+	std::string prefix;
+	std::string text;
+	std::vector<u64> args;
+	std::vector<std::string> strings;
+
+	while (true)
+	{
+		const bool stop = formatter_stop;
+
+		{
+			reader_lock lock(rings_mutex);
+			active = rings;
+		}
+
+		// Collect messages from all threads
+		batch.clear();
+		ends.resize(active.size());
+
+		for (std::size_t i = 0; i < active.size(); i++)
+		{
+			const deferred_ring& ring = *active[i];
+			const uchar* const base = reinterpret_cast<const uchar*>(ring.data.get());
+			const u64 end = ring.push;
+
+			for (u64 pos = ring.pop; pos < end;)
+			{
+				const auto rec = reinterpret_cast<const deferred_record*>(base + pos % deferred_ring::size);
+
+				if (rec->argc != UINT32_MAX)
+				{
+					batch.emplace_back(rec);
+				}
+
+				pos += rec->size;
+			}
+
+			ends[i] = end;
+		}
+
+		// Restore global order
+		std::stable_sort(batch.begin(), batch.end(), [](const deferred_record* a, const deferred_record* b)
+		{
+			return a->stamp < b->stamp;
+		});
+
+		for (const deferred_record* rec : batch)
+		{
+			const u64* arg_data = reinterpret_cast<const u64*>(rec + 1);
+			const char* str = reinterpret_cast<const char*>(arg_data + rec->argc);
+
+			prefix.assign(str, rec->prefix_size);
+			str += rec->prefix_size;
+
+			if (!rec->fmt)
+			{
+				text.assign(str, rec->data_size);
+			}
+			else
+			{
+				// Substitute copied strings
+				args.assign(arg_data, arg_data + rec->argc);
+				strings.clear();
+				strings.reserve(rec->argc);
+
+				for (u32 i = 0; i < rec->argc; i++)
+				{
+					if (rec->sup[i].storage == fmt_type_info::c_string)
+					{
+						if (const u64 len = args[i]; len != UINT64_MAX)
+						{
+							args[i] = reinterpret_cast<u64>(strings.emplace_back(str, len).c_str());
+							str += len;
+						}
+						else
+						{
+							args[i] = 0;
+						}
+					}
+					else if (rec->sup[i].storage == fmt_type_info::std_string)
+					{
+						const u64 len = args[i];
+						args[i] = reinterpret_cast<u64>(&strings.emplace_back(str, len));
+						str += len;
+					}
+				}
+
+				text.clear();
+				fmt::raw_append(text, rec->fmt, rec->sup, args.data());
+			}
+
+			for (listener* lis = this; lis; lis = lis->m_next)
+			{
+				lis->log(rec->stamp, *rec->msg, prefix, text);
+			}
+		}
+
+		for (std::size_t i = 0; i < active.size(); i++)
+		{
+			active[i]->pop.release(ends[i]);
+		}
+
+		// Remove rings of finished threads
+		if (std::any_of(active.begin(), active.end(), [](const auto& ring) { return ring->orphan && ring->pop == ring->push; }))
+		{
+			std::lock_guard lock(rings_mutex);
+
+			rings.erase(std::remove_if(rings.begin(), rings.end(), [](const auto& ring)
+			{
+				return ring->orphan && ring->pop == ring->push;
+			}), rings.end());
+		}
+
+		if (batch.empty())
+		{
+			if (stop)
+			{
+				break;
+			}
+
+			std::this_thread::sleep_for(1ms);
+		}
+	}
+}
@@ -22,6 +22,7 @@ namespace logs
 	};
 
 	struct channel;
+	struct file_listener;
 
 	// Message information
 	struct message
@@ -42,6 +43,7 @@ namespace logs
 		atomic_t<listener*> m_next{};
 
 		friend struct message;
+		friend struct file_listener;
 
 	public:
 		constexpr listener() = default;
@@ -108,6 +110,9 @@ namespace logs
 
 	// Log level control: register channel if necessary, set channel level
 	void set_level(const std::string&, level);
+
+	// Format messages in the background thread instead of the calling thread (errors are still written synchronously)
+	void set_deferred(bool enabled);
 }
 
 #define LOG_CHANNEL(ch, ...) ::logs::channel ch(#ch, ##__VA_ARGS__)
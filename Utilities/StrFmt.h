@@ -234,12 +234,24 @@ struct fmt_type_info
 {
 	decltype(&fmt_class_string<int>::format) fmt_string;
 
+	// Argument storage class (used to format the arguments later, for example in another thread)
+	enum : uint
+	{
+		by_ref, // The argument is an address of the object
+		by_value,
+		c_string,
+		std_string,
+	} storage;
+
 	template <typename T>
 	static constexpr fmt_type_info make()
 	{
 		return fmt_type_info
 		{
 			&fmt_class_string<T>::format,
+			std::is_same<T, const char*>::value ? c_string :
+			std::is_same<T, std::string>::value ? std_string :
+			std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value ? by_value : by_ref,
 		};
 	}
 };
@@ -7,6 +7,7 @@
 #include "Emu/Cell/RawSPUThread.h"
 #include "Emu/Cell/lv2/sys_mmapper.h"
 #include "Emu/Cell/lv2/sys_event.h"
+#include "Emu/CPU/CPUTimeStats.h"
 #include "Thread.h"
 #include "sysinfo.h"
 #include <typeinfo>
@@ -1094,6 +1095,8 @@ bool handle_access_violation(u32 addr, bool is_writing, x64_context* context)
 {
 	g_tls_fault_all++;
 
+	cpu_activity_scope scope(cpu_activity::fault);
+
 	const auto cpu = get_current_cpu_thread();
 
 	if (rsx::g_access_violation_handler)
@@ -1943,221 +1946,310 @@ u64 thread_base::get_cycles()
 	}
 }
 
-void thread_ctrl::detect_cpu_layout()
+namespace
 {
-	if (!g_native_core_layout.compare_and_swap_test(native_core_arrangement::undefined, native_core_arrangement::generic))
-		return;
+	// Logical CPU sets of the host (only the first 64 CPUs are used)
+	struct cpu_topology
+	{
+		u64 all = 0;
+		std::vector<u64> cores; // SMT siblings
+		std::vector<u64> l3; // Shared L3 cache domains
+		std::vector<u64> nodes; // NUMA nodes
+	};
 
-	const auto system_id = utils::get_system_info();
-	if (system_id.find("Ryzen") != std::string::npos)
+	// Thread placement derived from the topology
+	struct cpu_layout
 	{
-		g_native_core_layout.store(native_core_arrangement::amd_ccx);
-	}
-	else if (system_id.find("Intel") != std::string::npos)
+		native_core_arrangement arrangement = native_core_arrangement::generic;
+		u64 masks[4]{}; // Indexed by thread_class
+	};
+
+	u32 count_cpus(u64 mask)
 	{
-#ifdef _WIN32
-		const LOGICAL_PROCESSOR_RELATIONSHIP relationship = LOGICAL_PROCESSOR_RELATIONSHIP::RelationProcessorCore;
-		DWORD buffer_size = 0;
+		return utils::popcnt32(static_cast<u32>(mask)) + utils::popcnt32(static_cast<u32>(mask >> 32));
+	}
 
-		// If buffer size is set to 0 bytes, it will be overwritten with the required size
-		if (GetLogicalProcessorInformationEx(relationship, nullptr, &buffer_size))
-		{
-			LOG_ERROR(GENERAL, "GetLogicalProcessorInformationEx returned 0 bytes");
-			return;
-		}
-		DWORD error_code = GetLastError();
-		if (error_code != ERROR_INSUFFICIENT_BUFFER)
+	void add_cpu_set(std::vector<u64>& sets, u64 mask)
+	{
+		if (mask && std::find(sets.begin(), sets.end(), mask) == sets.end())
 		{
-			LOG_ERROR(GENERAL, "Unexpected windows error code when detecting CPU layout: %u", error_code);
-			return;
+			sets.push_back(mask);
 		}
+	}
 
-		std::vector<u8> buffer(buffer_size);
+#ifdef __linux__
+	// Read small sysfs file (its reported size is not reliable)
+	std::string read_sysfs(const std::string& path)
+	{
+		char buf[256];
 
-		if (!GetLogicalProcessorInformationEx(relationship,
-			reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(buffer.data()), &buffer_size))
+		if (const fs::file f{path})
 		{
-			LOG_ERROR(GENERAL, "GetLogicalProcessorInformationEx failed (size=%u, error=%u)", buffer_size, GetLastError());
+			return std::string(buf, f.read(buf, sizeof(buf)));
 		}
-		else
+
+		return {};
+	}
+
+	// Parse CPU list ("0-3,8-11")
+	u64 parse_cpu_list(const std::string& list)
+	{
+		u64 mask = 0;
+
+		for (const char* ptr = list.c_str(); *ptr >= '0' && *ptr <= '9';)
 		{
-			// Iterate through the buffer until a core with hyperthreading is found
-			auto ptr = reinterpret_cast<std::uintptr_t>(buffer.data());
-			const std::uintptr_t end = ptr + buffer_size;
+			char* end;
+			const ullong first = std::strtoull(ptr, &end, 10);
+			ullong last = first;
 
-			while (ptr < end)
+			if (*end == '-')
 			{
-				auto info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(ptr);
-				if (info->Relationship == relationship && info->Processor.Flags == LTP_PC_SMT)
-				{
-					g_native_core_layout.store(native_core_arrangement::intel_ht);
-					break;
-				}
-				ptr += info->Size;
+				last = std::strtoull(end + 1, &end, 10);
 			}
+
+			for (ullong cpu = first; cpu <= last && cpu < 64; cpu++)
+			{
+				mask |= 1ull << cpu;
+			}
+
+			ptr = *end == ',' ? end + 1 : end;
 		}
-#else
-		LOG_TODO(GENERAL, "Thread scheduler is not implemented for Intel and this OS");
-#endif
-	}
-}
 
-u64 thread_ctrl::get_affinity_mask(thread_class group)
-{
-	detect_cpu_layout();
+		return mask;
+	}
+#endif
 
-	if (const auto thread_count = std::thread::hardware_concurrency())
+	cpu_topology get_cpu_topology()
 	{
-		const u64 all_cores_mask = thread_count < 64 ? UINT64_MAX >> (64 - thread_count): UINT64_MAX;
+		cpu_topology topo;
 
-		switch (g_native_core_layout)
-		{
-		default:
-		case native_core_arrangement::generic:
-		{
-			return all_cores_mask;
-		}
-		case native_core_arrangement::amd_ccx:
+#ifdef _WIN32
+		DWORD buffer_size = 0;
+		GetLogicalProcessorInformationEx(RelationAll, nullptr, &buffer_size);
+
+		std::vector<u8> buffer(buffer_size);
+
+		if (buffer_size && GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data()), &buffer_size))
 		{
-			u64 spu_mask, ppu_mask, rsx_mask;
-			const auto system_id = utils::get_system_info();
-			if (thread_count >= 32)
+			for (DWORD pos = 0; pos < buffer_size;)
 			{
-				if (system_id.find("3950X") != std::string::npos)
+				const auto info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + pos);
+
+				switch (info->Relationship)
+				{
+				case RelationProcessorCore:
 				{
-					// zen2
-					// Ryzen 9 3950X
-					// Assign threads 9-32
-					ppu_mask = 0b11111111000000000000000000000000;
-					spu_mask = 0b00000000111111110000000000000000;
-					rsx_mask = 0b00000000000000001111111100000000;
+					if (info->Processor.GroupMask[0].Group == 0)
+					{
+						add_cpu_set(topo.cores, info->Processor.GroupMask[0].Mask);
+						topo.all |= info->Processor.GroupMask[0].Mask;
+					}
+
+					break;
 				}
-				else if (system_id.find("2970WX") != std::string::npos)
+				case RelationCache:
 				{
-					// zen+
-					// Threadripper 2970WX
-					// Assign threads 9-24
-					ppu_mask = 0b000000111111000000000000;
-					spu_mask = ppu_mask;
-					rsx_mask = 0b111111000000000000000000;
+					if (info->Cache.Level == 3 && info->Cache.GroupMask.Group == 0)
+					{
+						add_cpu_set(topo.l3, info->Cache.GroupMask.Mask);
+					}
+
+					break;
 				}
-				else
+				case RelationNumaNode:
 				{
-					// zen(+)
-					// Threadripper 1950X/2950X/2990WX
-					// Assign threads 17-32
-					ppu_mask = 0b00000000111111110000000000000000;
-					spu_mask = ppu_mask;
-					rsx_mask = 0b11111111000000000000000000000000;
+					if (info->NumaNode.GroupMask.Group == 0)
+					{
+						add_cpu_set(topo.nodes, info->NumaNode.GroupMask.Mask);
+					}
+
+					break;
+				}
+				default: break;
 				}
 
+				pos += info->Size;
 			}
-			else if (thread_count == 24)
+		}
+		else
+		{
+			LOG_ERROR(GENERAL, "GetLogicalProcessorInformationEx failed (size=%u, error=%u)", buffer_size, GetLastError());
+		}
+#elif defined(__linux__)
+		for (u32 cpu = 0; cpu < 64; cpu++)
+		{
+			const std::string path = fmt::format("/sys/devices/system/cpu/cpu%u/", cpu);
+
+			// Offline CPUs have no topology information
+			const u64 siblings = parse_cpu_list(read_sysfs(path + "topology/thread_siblings_list"));
+
+			if (!siblings)
 			{
-				if (system_id.find("3900X") != std::string::npos)
-				{
-					// zen2
-					// Ryzen 9 3900X
-					// Assign threads 7-22
-					ppu_mask = 0b111111000000000000000000;
-					spu_mask = 0b000000111111000000000000;
-					rsx_mask = 0b000000000000111111000000;
-				}
-				else
-				{
-					// zen(+)
-					// Threadripper 1920X/2920X
-					// Assign threads 13-24
-					ppu_mask = 0b000000111111000000000000;
-					spu_mask = ppu_mask;
-					rsx_mask = 0b111111000000000000000000;
-				}
+				continue;
 			}
-			else if (thread_count == 16)
+
+			topo.all |= 1ull << cpu;
+			add_cpu_set(topo.cores, siblings);
+
+			for (u32 index = 0;; index++)
 			{
-				if (system_id.find("3700X") != std::string::npos || system_id.find("3800X") != std::string::npos)
+				const std::string level = read_sysfs(fmt::format("%scache/index%u/level", path, index));
+
+				if (level.empty())
 				{
-					// Ryzen 7 3700/3800 (x)
-					// Assign threads 1-16
-					ppu_mask = 0b0000000011110000;
-					spu_mask = 0b1111111100000000;
-					rsx_mask = 0b0000000000001111;
+					break;
 				}
-				else
+
+				if (level[0] == '3')
 				{
-					// zen(+)
-					// Ryzen 7, Threadripper
-					// Assign threads 3-16
-					ppu_mask = 0b1111111100000000;
-					spu_mask = ppu_mask;
-					rsx_mask = 0b0000000000111100;
+					add_cpu_set(topo.l3, parse_cpu_list(read_sysfs(fmt::format("%scache/index%u/shared_cpu_list", path, index))));
 				}
 			}
-			else if (thread_count == 12)
+		}
+
+		for (u32 node = 0; node < 64; node++)
+		{
+			add_cpu_set(topo.nodes, parse_cpu_list(read_sysfs(fmt::format("/sys/devices/system/node/node%u/cpulist", node))));
+		}
+#endif
+
+		if (!topo.all)
+		{
+			// Topology is unknown
+			const u32 thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+			topo.all = thread_count < 64 ? UINT64_MAX >> (64 - thread_count) : UINT64_MAX;
+		}
+
+		// Order by the first CPU
+		for (auto* sets : {&topo.cores, &topo.l3, &topo.nodes})
+		{
+			std::sort(sets->begin(), sets->end(), [](u64 a, u64 b)
 			{
-				if (system_id.find("3600") != std::string::npos)
+				return utils::cnttz64(a) < utils::cnttz64(b);
+			});
+		}
+
+		return topo;
+	}
+
+	cpu_layout get_cpu_layout(const cpu_topology& topo)
+	{
+		cpu_layout layout;
+
+		for (u64& mask : layout.masks)
+		{
+			mask = topo.all;
+		}
+
+		if (topo.l3.size() >= 2)
+		{
+			layout.arrangement = native_core_arrangement::amd_ccx;
+
+			const auto get_node = [&](u64 mask) -> u64
+			{
+				for (u64 node : topo.nodes)
 				{
-					// zen2
-					// R5 3600 (x)
-					// Assign threads 1-12
-					ppu_mask = 0b000000111000;
-					spu_mask = 0b111111000000;
-					rsx_mask = 0b000000000111;
+					if ((node & mask) == mask)
+					{
+						return node;
+					}
 				}
-				else
+
+				return topo.all;
+			};
+
+			// Prefer the last L3 domains (the first CPUs usually handle more OS work) within one NUMA node
+			const u64 node = get_node(topo.l3.back());
+
+			std::vector<u64> local;
+
+			for (u64 mask : topo.l3)
+			{
+				if (get_node(mask) == node)
 				{
-					// zen(+)
-					// R5 1600/2600 (x)
-					// Assign threads 3-12
-					ppu_mask = 0b111111000000;
-					spu_mask = ppu_mask;
-					rsx_mask = 0b000000111100;
+					local.push_back(mask);
 				}
 			}
-			else
+
+			if (local.size() < 2)
 			{
-				// R5 & R3 don't seem to improve performance no matter how these are shuffled
-				ppu_mask = spu_mask = rsx_mask = 0b11111111 & all_cores_mask;
+				local = topo.l3;
 			}
 
-			switch (group)
+			// Group PPU and SPU threads on shared-L3 cores (at least 12 threads if possible), keep one L3 domain for RSX
+			std::size_t index = local.size() - 1;
+			u64 main_mask = local[index];
+
+			while (count_cpus(main_mask) < 12 && index > 1)
 			{
-			default:
-			case thread_class::general:
-				return all_cores_mask;
-			case thread_class::rsx:
-				return rsx_mask;
-			case thread_class::ppu:
-				return ppu_mask;
-			case thread_class::spu:
-				return spu_mask;
+				main_mask |= local[--index];
 			}
+
+			layout.masks[static_cast<u32>(thread_class::ppu)] = main_mask;
+			layout.masks[static_cast<u32>(thread_class::spu)] = main_mask;
+			layout.masks[static_cast<u32>(thread_class::rsx)] = local[index - 1];
 		}
-		case native_core_arrangement::intel_ht:
+		else if (topo.cores.size() < count_cpus(topo.all))
 		{
-			/* This has been disabled as it seems to degrade performance instead of improving it.
-			if (thread_count <= 4)
-			{
-				//i3 or worse
-				switch (group)
-				{
-				case thread_class::rsx:
-				case thread_class::ppu:
-					return (0b0101 & all_cores_mask);
-				case thread_class::spu:
-					return (0b1010 & all_cores_mask);
-				case thread_class::general:
-					return all_cores_mask;
-				}
-			}
-			*/
-
-			return all_cores_mask;
+			// Splitting SMT siblings between thread classes seems to degrade performance
+			layout.arrangement = native_core_arrangement::intel_ht;
 		}
+
+		return layout;
+	}
+
+	const cpu_layout& get_cpu_layout()
+	{
+		static const cpu_layout s_layout = []
+		{
+			const cpu_topology topo = get_cpu_topology();
+			const cpu_layout layout = get_cpu_layout(topo);
+
+			LOG_NOTICE(GENERAL, "CPU topology: %u threads, %u cores, %u L3 domains, %u NUMA nodes (PPU: 0x%x, SPU: 0x%x, RSX: 0x%x)",
+				count_cpus(topo.all), topo.cores.size(), topo.l3.size(), topo.nodes.size(),
+				layout.masks[static_cast<u32>(thread_class::ppu)], layout.masks[static_cast<u32>(thread_class::spu)], layout.masks[static_cast<u32>(thread_class::rsx)]);
+
+			return layout;
+		}();
+
+		return s_layout;
+	}
+}
+
+void thread_ctrl::detect_cpu_layout()
+{
+	if (g_native_core_layout == native_core_arrangement::undefined)
+	{
+		g_native_core_layout = get_cpu_layout().arrangement;
+	}
+}
+
+u64 thread_ctrl::get_affinity_mask(thread_class group)
+{
+	detect_cpu_layout();
+
+	// User override (hexadecimal mask)
+	const cfg::string* forced = nullptr;
+
+	switch (group)
+	{
+	case thread_class::ppu: forced = &g_cfg.core.ppu_affinity; break;
+	case thread_class::spu: forced = &g_cfg.core.spu_affinity; break;
+	case thread_class::rsx: forced = &g_cfg.core.rsx_affinity; break;
+	default: break;
+	}
+
+	if (forced && forced->size())
+	{
+		if (const u64 mask = std::strtoull(forced->get().c_str(), nullptr, 16))
+		{
+			return mask;
 		}
+
+		LOG_ERROR(GENERAL, "Invalid affinity mask: %s", forced->get());
 	}
 
-	return UINT64_MAX;
+	return get_cpu_layout().masks[static_cast<u32>(group)];
 }
 
 void thread_ctrl::set_native_priority(int priority)
@@ -22,8 +22,8 @@ enum class native_core_arrangement : u32
 {
 	undefined,
 	generic,
-	intel_ht,
-	amd_ccx
+	intel_ht, // Single L3 cache domain with SMT
+	amd_ccx // Several L3 cache domains
 };
 
 enum class thread_class : u32
@@ -254,10 +254,10 @@ public:
 		return g_tls_this_thread;
 	}
 
-	// Detect layout
+	// Detect layout from the host CPU topology (SMT siblings, L3 cache domains, NUMA nodes)
 	static void detect_cpu_layout();
 
-	// Returns a core affinity mask. Set whether to generate the high priority set or not
+	// Returns a core affinity mask for the thread class (can be overridden in the config)
 	static u64 get_affinity_mask(thread_class group);
 
 	// Sets the native thread priority
@@ -3,6 +3,8 @@
 #include "types.h"
 #include "util/atomic.hpp"
 
+#include <memory>
+
 //! Simple sizeless array base for concurrent access. Cannot shrink, only growths automatically.
 //! There is no way to know the current size. The smaller index is, the faster it's accessed.
 //!
@@ -146,6 +148,160 @@ public:
 	}
 };
 
+//! Bounded lock-free FIFO queue (multiple producers, multiple consumers) with preallocated storage.
+//! Capacity is set on construction; push fails instead of allocating memory when the queue is full.
+//! T must be default-constructible and assignable.
+template <typename T>
+class lf_ring
+{
+	struct slot_t
+	{
+		// Sequence number: equals push position when free, push position + 1 when filled
+		atomic_t<u32> seq;
+
+		T data{};
+	};
+
+	std::unique_ptr<slot_t[]> m_slots;
+
+	// Slot count minus one (slot count is a power of two)
+	const u32 m_mask;
+
+	// Max element count (may be lower than the slot count)
+	const u32 m_limit;
+
+	alignas(64) atomic_t<u32> m_push{0};
+	alignas(64) atomic_t<u32> m_pop{0};
+
+	static u32 get_slot_count(u32 limit)
+	{
+		u32 count = 1;
+
+		while (count < limit)
+		{
+			count *= 2;
+		}
+
+		return count;
+	}
+
+public:
+	explicit lf_ring(u32 limit)
+		: m_slots(std::make_unique<slot_t[]>(get_slot_count(limit)))
+		, m_mask(get_slot_count(limit) - 1)
+		, m_limit(limit)
+	{
+		for (u32 i = 0; i <= m_mask; i++)
+		{
+			m_slots[i].seq.raw() = i;
+		}
+	}
+
+	lf_ring(const lf_ring&) = delete;
+
+	lf_ring& operator=(const lf_ring&) = delete;
+
+	// Get max element count
+	u32 capacity() const
+	{
+		return m_limit;
+	}
+
+	// Get current element count (approximate if accessed concurrently)
+	u32 size() const
+	{
+		return m_push.load() - m_pop.load();
+	}
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	// Try to add an element, return false if the queue is full
+	template <typename... Args>
+	bool try_push(Args&&... args)
+	{
+		u32 pos = m_push.load();
+
+		while (true)
+		{
+			slot_t& slot = m_slots[pos & m_mask];
+
+			const s32 diff = static_cast<s32>(slot.seq.load() - pos);
+
+			if (diff == 0)
+			{
+				if (pos - m_pop.load() >= m_limit)
+				{
+					return false;
+				}
+
+				if (m_push.compare_exchange(pos, pos + 1))
+				{
+					slot.data = T(std::forward<Args>(args)...);
+					slot.seq.store(pos + 1);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				// Full (the slot wasn't released yet)
+				return false;
+			}
+			else
+			{
+				pos = m_push.load();
+			}
+		}
+	}
+
+	// Try to extract the oldest element, return false if the queue is empty
+	bool try_pop(T& out)
+	{
+		u32 pos = m_pop.load();
+
+		while (true)
+		{
+			slot_t& slot = m_slots[pos & m_mask];
+
+			const s32 diff = static_cast<s32>(slot.seq.load() - (pos + 1));
+
+			if (diff == 0)
+			{
+				if (m_pop.compare_exchange(pos, pos + 1))
+				{
+					out = std::move(slot.data);
+					slot.seq.store(pos + m_mask + 1);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				// Empty (or the element is not published yet)
+				return false;
+			}
+			else
+			{
+				pos = m_pop.load();
+			}
+		}
+	}
+
+	// Remove all elements, return the number of elements removed
+	u32 clear()
+	{
+		u32 count = 0;
+
+		for (T tmp; try_pop(tmp);)
+		{
+			count++;
+		}
+
+		return count;
+	}
+};
+
 // Helper type, linked list element
 template <typename T>
 class lf_queue_item final
@@ -31,6 +31,8 @@ namespace utils
 
 	bool has_sse41();
 
+	bool has_aes();
+
 	bool has_avx();
 
 	bool has_avx2();
@@ -31,6 +31,11 @@
 
 #include "aes.h"
 
+#if defined(_M_X64) || defined(__x86_64__)
+#include "Utilities/sysinfo.h"
+#include <immintrin.h>
+#endif
+
 /*
  * 32-bit integer manipulation macros (little endian)
  */
@@ -632,6 +637,183 @@ int aes_setkey_dec( aes_context *ctx, const unsigned char *key, unsigned int key
                  RT3[ ( Y0 >> 24 ) & 0xFF ];    \
 }
 
+/*
+ * AES-NI implementation (selected at runtime)
+ *
+ * Uses the same key schedule as the table-based code: decryption round keys
+ * from aes_setkey_dec() are already transformed for the equivalent inverse cipher.
+ */
+#if defined(_M_X64) || defined(__x86_64__)
+
+#define AES_USE_AESNI
+
+#ifdef _MSC_VER
+#define AESNI_FUNC
+#else
+#define AESNI_FUNC __attribute__((__target__("aes,sse4.1")))
+#endif
+
+struct aesni_keys
+{
+    __m128i k[15];
+    int nr;
+
+    AESNI_FUNC explicit aesni_keys( const aes_context *ctx )
+        : nr( ctx->nr )
+    {
+        for( int i = 0; i <= nr; i++ )
+            k[i] = _mm_loadu_si128( reinterpret_cast<const __m128i*>( ctx->rk + i * 4 ) );
+    }
+
+    AESNI_FUNC __m128i enc( __m128i x ) const
+    {
+        x = _mm_xor_si128( x, k[0] );
+
+        for( int i = 1; i < nr; i++ )
+            x = _mm_aesenc_si128( x, k[i] );
+
+        return _mm_aesenclast_si128( x, k[nr] );
+    }
+
+    AESNI_FUNC __m128i dec( __m128i x ) const
+    {
+        x = _mm_xor_si128( x, k[0] );
+
+        for( int i = 1; i < nr; i++ )
+            x = _mm_aesdec_si128( x, k[i] );
+
+        return _mm_aesdeclast_si128( x, k[nr] );
+    }
+
+    // Process 4 independent blocks at once to hide the instruction latency
+    AESNI_FUNC void enc4( __m128i x[4] ) const
+    {
+        for( int j = 0; j < 4; j++ )
+            x[j] = _mm_xor_si128( x[j], k[0] );
+
+        for( int i = 1; i < nr; i++ )
+            for( int j = 0; j < 4; j++ )
+                x[j] = _mm_aesenc_si128( x[j], k[i] );
+
+        for( int j = 0; j < 4; j++ )
+            x[j] = _mm_aesenclast_si128( x[j], k[nr] );
+    }
+
+    AESNI_FUNC void dec4( __m128i x[4] ) const
+    {
+        for( int j = 0; j < 4; j++ )
+            x[j] = _mm_xor_si128( x[j], k[0] );
+
+        for( int i = 1; i < nr; i++ )
+            for( int j = 0; j < 4; j++ )
+                x[j] = _mm_aesdec_si128( x[j], k[i] );
+
+        for( int j = 0; j < 4; j++ )
+            x[j] = _mm_aesdeclast_si128( x[j], k[nr] );
+    }
+};
+
+static inline __m128i aesni_load( const unsigned char *p )
+{
+    return _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+}
+
+static inline void aesni_store( unsigned char *p, __m128i x )
+{
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( p ), x );
+}
+
+AESNI_FUNC static void aesni_crypt_ecb( const aes_context *ctx, int mode, const unsigned char input[16], unsigned char output[16] )
+{
+    const aesni_keys keys( ctx );
+
+    aesni_store( output, mode == AES_DECRYPT ? keys.dec( aesni_load( input ) ) : keys.enc( aesni_load( input ) ) );
+}
+
+AESNI_FUNC static void aesni_crypt_cbc( const aes_context *ctx, int mode, size_t length, unsigned char iv[16], const unsigned char *input, unsigned char *output )
+{
+    const aesni_keys keys( ctx );
+
+    __m128i prev = aesni_load( iv );
+
+    if( mode == AES_DECRYPT )
+    {
+        for( ; length >= 64; input += 64, output += 64, length -= 64 )
+        {
+            __m128i c[4], x[4];
+
+            for( int j = 0; j < 4; j++ )
+                x[j] = c[j] = aesni_load( input + j * 16 );
+
+            keys.dec4( x );
+
+            aesni_store( output, _mm_xor_si128( x[0], prev ) );
+
+            for( int j = 1; j < 4; j++ )
+                aesni_store( output + j * 16, _mm_xor_si128( x[j], c[j - 1] ) );
+
+            prev = c[3];
+        }
+
+        for( ; length >= 16; input += 16, output += 16, length -= 16 )
+        {
+            const __m128i c = aesni_load( input );
+            aesni_store( output, _mm_xor_si128( keys.dec( c ), prev ) );
+            prev = c;
+        }
+    }
+    else
+    {
+        for( ; length >= 16; input += 16, output += 16, length -= 16 )
+        {
+            prev = keys.enc( _mm_xor_si128( aesni_load( input ), prev ) );
+            aesni_store( output, prev );
+        }
+    }
+
+    aesni_store( iv, prev );
+}
+
+// Process full blocks in CTR mode (128-bit big-endian counter)
+AESNI_FUNC static void aesni_crypt_ctr( const aes_context *ctx, size_t blocks, unsigned char nonce_counter[16], const unsigned char *input, unsigned char *output )
+{
+    const aesni_keys keys( ctx );
+
+    // Byte-swap mask between the big-endian counter and two native 64-bit halves
+    const __m128i bswap = _mm_set_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+
+    const __m128i ctr = _mm_shuffle_epi8( aesni_load( nonce_counter ), bswap );
+    unsigned long long lo = _mm_cvtsi128_si64( ctr );
+    unsigned long long hi = _mm_extract_epi64( ctr, 1 );
+
+    const auto next = [&]() AESNI_FUNC
+    {
+        const __m128i r = _mm_shuffle_epi8( _mm_set_epi64x( hi, lo ), bswap );
+        hi += ++lo == 0;
+        return r;
+    };
+
+    for( ; blocks >= 4; input += 64, output += 64, blocks -= 4 )
+    {
+        __m128i x[4];
+
+        for( int j = 0; j < 4; j++ )
+            x[j] = next();
+
+        keys.enc4( x );
+
+        for( int j = 0; j < 4; j++ )
+            aesni_store( output + j * 16, _mm_xor_si128( x[j], aesni_load( input + j * 16 ) ) );
+    }
+
+    for( ; blocks; input += 16, output += 16, blocks-- )
+        aesni_store( output, _mm_xor_si128( keys.enc( next() ), aesni_load( input ) ) );
+
+    aesni_store( nonce_counter, _mm_shuffle_epi8( _mm_set_epi64x( hi, lo ), bswap ) );
+}
+
+#endif
+
 /*
  * AES-ECB block encryption/decryption
  */
@@ -643,6 +825,14 @@ int aes_crypt_ecb( aes_context *ctx,
     int i;
     uint32_t *RK, X0, X1, X2, X3, Y0, Y1, Y2, Y3;
 
+#ifdef AES_USE_AESNI
+    if( utils::has_aes() )
+    {
+        aesni_crypt_ecb( ctx, mode, input, output );
+        return( 0 );
+    }
+#endif
+
     RK = ctx->rk;
 
     GET_UINT32_LE( X0, input,  0 ); X0 ^= *RK++;
@@ -743,6 +933,14 @@ int aes_crypt_cbc( aes_context *ctx,
     if( length % 16 )
         return( POLARSSL_ERR_AES_INVALID_INPUT_LENGTH );
 
+#ifdef AES_USE_AESNI
+    if( utils::has_aes() )
+    {
+        aesni_crypt_cbc( ctx, mode, length, iv, input, output );
+        return( 0 );
+    }
+#endif
+
     if( mode == AES_DECRYPT )
     {
         while( length > 0 )
@@ -839,6 +1037,24 @@ int aes_crypt_ctr( aes_context *ctx,
     int c, i;
     size_t n = *nc_off;
 
+#ifdef AES_USE_AESNI
+    if( utils::has_aes() )
+    {
+        // Finish the current stream block, then process full blocks at once
+        for( ; n && length; length-- )
+        {
+            *output++ = (unsigned char)( *input++ ^ stream_block[n] );
+            n = (n + 1) & 0x0F;
+        }
+
+        const size_t blocks = length / 16;
+        aesni_crypt_ctr( ctx, blocks, nonce_counter, input, output );
+        input  += blocks * 16;
+        output += blocks * 16;
+        length -= blocks * 16;
+    }
+#endif
+
     while( length-- )
     {
         if( n == 0 ) {
@@ -2,7 +2,150 @@
 #include "key_vault.h"
 #include "unedat.h"
 
+#include "Utilities/Thread.h"
+#include "Emu/IdManager.h"
+
 #include <cmath>
+#include <deque>
+#include <functional>
+#include <thread>
+
+// Helper threads decrypting EDATA blocks, shared by all EDATA files (fxm object, destroyed with the emulation)
+class edat_decrypt_pool
+{
+	struct worker
+	{
+		edat_decrypt_pool& pool;
+
+		void operator()();
+	};
+
+	// Only one parallel job is processed at a time, other callers decrypt alone
+	shared_mutex m_job_mutex;
+
+	// Current job and its generation, background tasks (protected by m_mutex)
+	shared_mutex m_mutex;
+	const std::function<void()>* m_func = nullptr;
+	u64 m_gen = 0;
+	std::deque<std::function<void()>> m_tasks;
+
+	// Number of workers running the current job
+	atomic_t<u32> m_active{0};
+
+	std::vector<std::unique_ptr<named_thread<worker>>> m_workers;
+
+public:
+	edat_decrypt_pool()
+	{
+		// The calling thread decrypts as well
+		const u32 count = std::clamp<u32>(std::thread::hardware_concurrency() / 2, 1, 8) - 1;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			m_workers.emplace_back(std::make_unique<named_thread<worker>>(fmt::format("EDAT Decrypter %u", i), worker{*this}));
+		}
+	}
+
+	~edat_decrypt_pool()
+	{
+		m_workers.clear();
+
+		// Tasks signal their completion to the waiting files, so they can't be dropped
+		for (auto& task : m_tasks)
+		{
+			task();
+		}
+	}
+
+	// Run func on the calling thread and on the idle workers (func must return when no work is left)
+	void run(const std::function<void()>& func)
+	{
+		std::unique_lock lock(m_job_mutex, std::try_to_lock);
+
+		if (!lock || m_workers.empty())
+		{
+			func();
+			return;
+		}
+
+		std::lock_guard{m_mutex}, m_func = &func, m_gen++;
+
+		notify();
+
+		func();
+
+		// Workers can't join the job anymore, wait for the ones running it
+		std::lock_guard{m_mutex}, m_func = nullptr;
+
+		while (m_active)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// Queue a task for a worker (returns false if there are no workers)
+	bool push(std::function<void()> task)
+	{
+		if (m_workers.empty())
+		{
+			return false;
+		}
+
+		std::lock_guard{m_mutex}, m_tasks.emplace_back(std::move(task));
+
+		notify();
+		return true;
+	}
+
+	void notify()
+	{
+		for (auto& w : m_workers)
+		{
+			thread_ctrl::notify(*w);
+		}
+	}
+};
+
+void edat_decrypt_pool::worker::operator()()
+{
+	u64 last_gen = 0;
+
+	while (thread_ctrl::state() != thread_state::aborting)
+	{
+		const std::function<void()>* func = nullptr;
+		std::function<void()> task;
+		{
+			std::lock_guard lock(pool.m_mutex);
+
+			if (pool.m_func && pool.m_gen != last_gen)
+			{
+				func = pool.m_func;
+				last_gen = pool.m_gen;
+				pool.m_active++;
+			}
+			else if (!pool.m_tasks.empty())
+			{
+				task = std::move(pool.m_tasks.front());
+				pool.m_tasks.pop_front();
+			}
+		}
+
+		if (func)
+		{
+			(*func)();
+			pool.m_active--;
+			continue;
+		}
+
+		if (task)
+		{
+			task();
+			continue;
+		}
+
+		thread_ctrl::wait();
+	}
+}
 
 void generate_key(int crypto_mode, int version, unsigned char *key_final, unsigned char *iv_final, unsigned char *key, unsigned char *iv)
 {
@@ -143,6 +286,7 @@ std::array<u8, 0x10> get_block_key(int block, NPD_HEADER *npd)
 
 // for out data, allocate a buffer the size of 'edat->block_size'
 // Also, set 'in file' to the beginning of the encrypted data, which may be offset if inside another file, but normally just reset to beginning of file
+// Only positional reads are used, so blocks of the same file may be decrypted concurrently
 // returns number of bytes written, -1 for error
 s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *npd, u8* crypt_key, u32 block_num, u32 total_blocks, u64 size_left)
 {
@@ -170,11 +314,9 @@ s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *np
 	{
 		metadata_sec_offset = metadata_offset + (unsigned long long) block_num * metadata_section_size;
 
-		in->seek(file_offset + metadata_sec_offset);
-
 		unsigned char metadata[0x20];
 		memset(metadata, 0, 0x20);
-		in->read(metadata, 0x20);
+		in->read_at(file_offset + metadata_sec_offset, metadata, 0x20);
 
 		// If the data is compressed, decrypt the metadata.
 		// NOTE: For NPD version 1 the metadata is not encrypted.
@@ -195,11 +337,10 @@ s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *np
 	{
 		// If FLAG 0x20, the metadata precedes each data block.
 		metadata_sec_offset = metadata_offset + (u64) block_num * (metadata_section_size + edat->block_size);
-		in->seek(file_offset + metadata_sec_offset);
 
 		unsigned char metadata[0x20];
 		memset(metadata, 0, 0x20);
-		in->read(metadata, 0x20);
+		in->read_at(file_offset + metadata_sec_offset, metadata, 0x20);
 		memcpy(hash_result, metadata, 0x14);
 
 		// If FLAG 0x20 is set, apply custom xor.
@@ -215,9 +356,8 @@ s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *np
 	else
 	{
 		metadata_sec_offset = metadata_offset + (u64) block_num * metadata_section_size;
-		in->seek(file_offset + metadata_sec_offset);
 
-		in->read(hash_result, 0x10);
+		in->read_at(file_offset + metadata_sec_offset, hash_result, 0x10);
 		offset = metadata_offset + (u64) block_num * edat->block_size + total_blocks * metadata_section_size;
 		length = edat->block_size;
 
@@ -235,8 +375,7 @@ s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *np
 	memset(hash, 0, 0x10);
 	memset(key_result, 0, 0x10);
 
-	in->seek(file_offset + offset);
-	in->read(enc_data.get(), length);
+	in->read_at(file_offset + offset, enc_data.get(), length);
 
 	// Generate a key for the current block.
 	std::array<u8, 0x10> b_key = get_block_key(block_num, npd);
@@ -937,43 +1076,271 @@ bool EDATADecrypter::ReadHeader()
 	file_size = edatHeader.file_size;
 	total_blocks = (u32)((edatHeader.file_size + edatHeader.block_size - 1) / edatHeader.block_size);
 
+	// Keep about 4 MB of decrypted blocks, read ahead 256 KB
+	cache_capacity = std::max<u32>(0x400000 / edatHeader.block_size, 16);
+	read_ahead_blocks = std::max<u32>(0x40000 / edatHeader.block_size, 1);
+
 	return true;
 }
 
+EDATADecrypter::~EDATADecrypter()
+{
+	// Wait for the background read ahead
+	{
+		std::lock_guard lock(cache_mutex);
+
+		while (!cache_pending.empty())
+		{
+			cache_cond.wait(cache_mutex);
+		}
+	}
+
+	// The last task may still be leaving cache_mutex
+	while (read_ahead_tasks)
+	{
+		std::this_thread::yield();
+	}
+
+	if (cache_hits || cache_misses)
+	{
+		LOG_NOTICE(LOADER, "EDAT: Block cache: %u hits, %u misses, %u read ahead", cache_hits, cache_misses, cache_read_ahead);
+	}
+}
+
+void EDATADecrypter::DecryptBlocks(const u32* blocks, u32 count, std::unique_ptr<u8[]>* bufs, s64* results)
+{
+	const u32 block_size = edatHeader.block_size;
+
+	atomic_t<u32> index{0};
+
+	auto worker = [&]
+	{
+		for (u32 i; (i = index++) < count;)
+		{
+			bufs[i].reset(new u8[block_size]);
+			results[i] = decrypt_block(&edata_file, bufs[i].get(), &edatHeader, &npdHeader, dec_key.data(), blocks[i], total_blocks, edatHeader.file_size);
+		}
+	};
+
+	// Decrypt multi-block reads with the helper threads (the input must support concurrent reads)
+	if (count < 4 || !edata_file.positional_io())
+	{
+		worker();
+		return;
+	}
+
+	GetDecryptPool().run(worker);
+}
+
+edat_decrypt_pool& EDATADecrypter::GetDecryptPool()
+{
+	if (!decrypt_pool)
+	{
+		decrypt_pool = fxm::get_always<edat_decrypt_pool>();
+	}
+
+	return *decrypt_pool;
+}
+
+void EDATADecrypter::StoreBlock(u32 block_num, std::unique_ptr<u8[]> data, u64 size)
+{
+	if (cache.size() >= cache_capacity)
+	{
+		// Evict the least recently used block
+		cache.erase(cache_lru.front());
+		cache_lru.pop_front();
+	}
+
+	auto& block = cache[block_num];
+	block.data = std::move(data);
+	block.size = size;
+	block.lru = cache_lru.insert(cache_lru.end(), block_num);
+}
+
+void EDATADecrypter::ReadAhead(const std::vector<u32>& blocks)
+{
+	std::vector<std::unique_ptr<u8[]>> bufs(blocks.size());
+	std::vector<s64> results(blocks.size());
+
+	for (u32 j = 0; j < blocks.size(); j++)
+	{
+		bufs[j].reset(new u8[edatHeader.block_size]);
+		results[j] = decrypt_block(&edata_file, bufs[j].get(), &edatHeader, &npdHeader, dec_key.data(), blocks[j], total_blocks, edatHeader.file_size);
+	}
+
+	{
+		std::lock_guard lock(cache_mutex);
+
+		for (u32 j = 0; j < blocks.size(); j++)
+		{
+			cache_pending.erase(blocks[j]);
+
+			// Failed blocks are decrypted again by the reader (which reports the error)
+			if (results[j] >= 0 && !cache.count(blocks[j]))
+			{
+				cache_read_ahead++;
+				StoreBlock(blocks[j], std::move(bufs[j]), results[j]);
+			}
+		}
+
+		cache_cond.notify_all();
+	}
+
+	read_ahead_tasks--;
+}
+
 u64 EDATADecrypter::ReadData(u64 pos, u8* data, u64 size)
 {
-	if (pos > edatHeader.file_size)
+	if (pos >= edatHeader.file_size || !size)
 		return 0;
 
-	// now we need to offset things to account for the actual 'range' requested
-	const u64 startOffset = pos % edatHeader.block_size;
+	size = std::min<u64>(size, edatHeader.file_size - pos);
+
+	std::lock_guard lock(cache_mutex);
 
-	const u32 num_blocks = static_cast<u32>(std::ceil((startOffset + size) / (double)edatHeader.block_size));
-	const u64 bufSize = num_blocks*edatHeader.block_size;
-	if (data_buf_size < (bufSize))
+	const u32 block_size = edatHeader.block_size;
+	const u32 first_block = static_cast<u32>(pos / block_size);
+	const u32 last_block = static_cast<u32>((pos + size - 1) / block_size);
+
+	// Read ahead on sequential access
+	const bool sequential = pos == last_read_end && pos != 0;
+	const u32 end_block = std::min<u32>(last_block + 1 + (sequential ? read_ahead_blocks : 0), total_blocks);
+
+	last_read_end = pos + size;
+
+	// Wait for the requested blocks being read ahead
+	for (u32 i = first_block; i <= last_block; i++)
 	{
-		data_buf.reset(new u8[bufSize]);
-		data_buf_size = bufSize;
+		while (cache_pending.count(i))
+		{
+			cache_cond.wait(cache_mutex);
+		}
 	}
 
-	// find and decrypt block range covering pos + size
-	const u32 starting_block = static_cast<u32>(pos / edatHeader.block_size);
-	const u32 ending_block = std::min(starting_block + num_blocks, total_blocks);
-	u64 writeOffset = 0;
-	for (u32 i = starting_block; i < ending_block; ++i)
+	// Copy a decrypted block to the output, return false if there is no more data
+	u64 written = 0;
+
+	auto copy_block = [&](u32 block, const u8* buf, u64 length)
 	{
-		edata_file.seek(0);
-		u64 res = decrypt_block(&edata_file, &data_buf[writeOffset], &edatHeader, &npdHeader, dec_key.data(), i, total_blocks, edatHeader.file_size);
-		if (res == -1)
+		const u64 start = block == first_block ? pos % block_size : 0;
+		const u64 offset = static_cast<u64>(block) * block_size + start - pos;
+
+		if (length <= start || offset != written)
+		{
+			return false;
+		}
+
+		const u64 count = std::min<u64>(length - start, size - written);
+		std::memcpy(data + written, buf + start, count);
+		written += count;
+		return length == block_size;
+	};
+
+	// Copy cached blocks and collect the missing ones
+	std::vector<u32> missing;
+
+	for (u32 i = first_block; i <= last_block; i++)
+	{
+		const auto found = cache.find(i);
+
+		if (found == cache.end())
+		{
+			missing.push_back(i);
+			continue;
+		}
+
+		cache_lru.splice(cache_lru.end(), cache_lru, found->second.lru);
+		cache_hits++;
+
+		if (missing.empty() && !copy_block(i, found->second.data.get(), found->second.size) && i != last_block)
+		{
+			return written;
+		}
+	}
+
+	if (!missing.empty())
+	{
+		std::vector<std::unique_ptr<u8[]>> bufs(missing.size());
+		std::vector<s64> results(missing.size());
+
+		DecryptBlocks(missing.data(), ::size32(missing), bufs.data(), results.data());
+
+		for (u32 j = 0; j < missing.size(); j++)
+		{
+			cache_misses++;
+
+			if (results[j] < 0)
+			{
+				LOG_ERROR(LOADER, "Error Decrypting data");
+				return 0;
+			}
+		}
+
+		// Copy the rest of the requested range in order (cached blocks may follow the first missing one)
+		u32 j = 0;
+
+		for (u32 i = missing[0]; i <= last_block; i++)
+		{
+			const u8* buf;
+			u64 length;
+
+			if (j < missing.size() && missing[j] == i)
+			{
+				buf = bufs[j].get();
+				length = results[j++];
+			}
+			else
+			{
+				const auto& block = cache.at(i);
+				buf = block.data.get();
+				length = block.size;
+			}
+
+			if (!copy_block(i, buf, length))
+			{
+				break;
+			}
+		}
+
+		// Store new blocks (large reads only keep their tail)
+		for (u32 j = missing.size() > cache_capacity ? ::size32(missing) - cache_capacity : 0; j < missing.size(); j++)
 		{
-			LOG_ERROR(LOADER, "Error Decrypting data");
-			return 0;
+			if (results[j] < 0)
+			{
+				continue;
+			}
+
+			StoreBlock(missing[j], std::move(bufs[j]), results[j]);
 		}
-		writeOffset += res;
 	}
 
-	const u64 bytesWrote = std::min<u64>(writeOffset - startOffset, size);
+	// Decrypt the next blocks on the helper threads (the input must support concurrent reads)
+	if (end_block > last_block + 1 && edata_file.positional_io())
+	{
+		std::vector<u32> ahead;
+
+		for (u32 i = last_block + 1; i < end_block; i++)
+		{
+			if (!cache.count(i) && !cache_pending.count(i))
+			{
+				ahead.push_back(i);
+			}
+		}
+
+		if (!ahead.empty())
+		{
+			read_ahead_tasks++;
+
+			if (GetDecryptPool().push([this, ahead] { ReadAhead(ahead); }))
+			{
+				cache_pending.insert(ahead.begin(), ahead.end());
+			}
+			else
+			{
+				read_ahead_tasks--;
+			}
+		}
+	}
 
-	memcpy(data, &data_buf[startOffset], bytesWrote);
-	return bytesWrote;
+	return written;
 }
@@ -1,10 +1,17 @@
 #pragma once
 
 #include <array>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "utils.h"
 
 #include "Utilities/File.h"
+#include "Utilities/mutex.h"
+#include "Utilities/cond.h"
 
 constexpr u32 SDAT_FLAG = 0x01000000;
 constexpr u32 EDAT_COMPRESSED_FLAG = 0x00000001;
@@ -48,6 +55,8 @@ extern bool VerifyEDATHeaderWithKLicense(const fs::file& input, const std::strin
 
 extern std::array<u8, 0x10> GetEdatRifKeyFromRapFile(const fs::file& rap_file);
 
+class edat_decrypt_pool;
+
 struct EDATADecrypter final : fs::file_base
 {
 	// file stream
@@ -59,9 +68,31 @@ struct EDATADecrypter final : fs::file_base
 	NPD_HEADER npdHeader;
 	EDAT_HEADER edatHeader;
 
-	// Internal data buffers.
-	std::unique_ptr<u8[]> data_buf;
-	u64 data_buf_size{0};
+	// Decrypted block cache (LRU)
+	struct cached_block
+	{
+		std::unique_ptr<u8[]> data;
+		u64 size;
+		std::list<u32>::iterator lru;
+	};
+
+	shared_mutex cache_mutex;
+	std::unordered_map<u32, cached_block> cache;
+	std::list<u32> cache_lru; // Cached block indices, least recently used first
+	u32 cache_capacity{16};
+	u32 read_ahead_blocks{1};
+	u64 last_read_end{0};
+
+	// Background read ahead (blocks being decrypted are pending, waiters use cache_cond)
+	cond_variable cache_cond;
+	std::unordered_set<u32> cache_pending;
+	atomic_t<u32> read_ahead_tasks{0};
+	std::shared_ptr<edat_decrypt_pool> decrypt_pool;
+
+	// Statistics (in blocks)
+	u64 cache_hits{0};
+	u64 cache_misses{0};
+	u64 cache_read_ahead{0};
 
 	std::array<u8, 0x10> dec_key{};
 
@@ -76,11 +107,26 @@ public:
 	EDATADecrypter(fs::file&& input, const std::array<u8, 0x10>& dev_key, const std::array<u8, 0x10>& rif_key)
 		: edata_file(std::move(input)), rif_key(rif_key), dev_key(dev_key) {}
 
-	~EDATADecrypter() override {}
+	~EDATADecrypter() override;
 	// false if invalid 
 	bool ReadHeader();
 	u64 ReadData(u64 pos, u8* data, u64 size);
 
+	// Decrypt the list of blocks (in parallel if there are many)
+	void DecryptBlocks(const u32* blocks, u32 count, std::unique_ptr<u8[]>* bufs, s64* results);
+
+private:
+	// Helper threads (created on first use, cache_mutex must be locked)
+	edat_decrypt_pool& GetDecryptPool();
+
+	// Insert a decrypted block into the cache (cache_mutex must be locked)
+	void StoreBlock(u32 block_num, std::unique_ptr<u8[]> data, u64 size);
+
+	// Decrypt the blocks in the background and cache them
+	void ReadAhead(const std::vector<u32>& blocks);
+
+public:
+
 	fs::stat_t stat() override
 	{
 		fs::stat_t stats;
@@ -102,6 +148,19 @@ public:
 		pos += bytesRead;
 		return bytesRead;
 	}
+	u64 read_at(u64 offset, void* buffer, u64 size) override
+	{
+		return ReadData(offset, static_cast<u8*>(buffer), size);
+	}
+	u64 write_at(u64 offset, const void* buffer, u64 size) override
+	{
+		return 0;
+	}
+	bool positional_io() override
+	{
+		// ReadData is serialized by cache_mutex and only reads the input file at explicit offsets
+		return edata_file.positional_io();
+	}
 	u64 write(const void* buffer, u64 size) override
 	{
 		return 0;
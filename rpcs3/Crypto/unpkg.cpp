@@ -7,10 +7,25 @@
 #include "Emu/System.h"
 #include "Emu/VFS.h"
 #include "unpkg.h"
+#include "Utilities/Thread.h"
+#include "Utilities/mutex.h"
+#include "Utilities/cond.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <chrono>
+#include <thread>
+
+// Size of the data processed at once by a worker
+constexpr u64 PKG_CHUNK_SIZE = 1024 * 1024;
+
+// Max number of chunks queued or being processed
+constexpr u32 PKG_MAX_PENDING = 64;
 
 bool pkg_install(const std::string& path, atomic_t<double>& sync)
 {
-	const std::size_t BUF_SIZE = 8192 * 1024; // 8 MB
+	const std::size_t BUF_SIZE = 64 * 1024; // 64 KB
 
 	std::vector<fs::file> filelist;
 	filelist.emplace_back(fs::file{path});
@@ -216,19 +231,51 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 		}
 	}
 
-	// Allocate buffer with BUF_SIZE size or more if required
-	const std::unique_ptr<u128[]> buf(new u128[std::max<u64>(BUF_SIZE, sizeof(PKGEntry) * header.file_count) / sizeof(u128)]);
+	// Positional reads of the parts are only serialized if a part doesn't support them natively
+	const bool archive_positional = std::all_of(filelist.begin(), filelist.end(), [](const fs::file& part) { return part.positional_io(); });
 
-	// Define decryption subfunction (`psp` arg selects the key for specific block)
-	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	std::mutex archive_mutex;
+
+	// Read at the specified archive offset (thread-safe, doesn't use the current position)
+	auto archive_read_at = [&](u64 offset, void* data_ptr, u64 num_bytes) -> u64
 	{
-		archive_seek(header.data_offset + offset);
+		std::unique_lock<std::mutex> lock;
 
-		// Read the data and set available size
-		const u64 read = archive_read(buf.get(), size);
+		if (!archive_positional)
+		{
+			lock = std::unique_lock(archive_mutex);
+		}
+
+		u64 result = 0;
+		u64 _offset = 0;
+
+		for (const fs::file& part : filelist)
+		{
+			const u64 part_size = part.size();
 
+			if (offset + result < _offset + part_size)
+			{
+				const u64 nread = part.read_at(offset + result - _offset, static_cast<u8*>(data_ptr) + result, std::min(num_bytes - result, _offset + part_size - offset - result));
+
+				result += nread;
+
+				if (result == num_bytes || offset + result < _offset + part_size)
+				{
+					break;
+				}
+			}
+
+			_offset += part_size;
+		}
+
+		return result;
+	};
+
+	// Decrypt data located at the specified offset in the data area (buf must be aligned to 16 bytes)
+	auto decrypt_buf = [&](u64 offset, u64 size, const uchar* key, u128* buf)
+	{
 		// Get block count
-		const u64 blocks = (read + 15) / 16;
+		const u64 blocks = (size + 15) / 16;
 
 		if (header.pkg_type == PKG_RELEASE_TYPE_DEBUG)
 		{
@@ -265,19 +312,27 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 			// Set encryption key for stream cipher
 			aes_setkey_enc(&ctx, key, 128);
 
-			// Initialize stream cipher for start position
+			// Initialize stream cipher for start position (the counter is incremented for every block)
 			be_t<u128> input = header.klicensee.value() + offset / 16;
 
-			// Increment stream position for every block
-			for (u64 i = 0; i < blocks; i++, input++)
-			{
-				u128 key;
+			std::size_t nc_off = 0;
+			u128 stream_block;
 
-				aes_crypt_ecb(&ctx, AES_ENCRYPT, reinterpret_cast<const u8*>(&input), reinterpret_cast<u8*>(&key));
-
-				buf[i] ^= key;
-			}
+			aes_crypt_ctr(&ctx, blocks * 16, &nc_off, reinterpret_cast<u8*>(&input), reinterpret_cast<u8*>(&stream_block),
+				reinterpret_cast<const u8*>(buf), reinterpret_cast<u8*>(buf));
 		}
+	};
+
+	// Allocate buffer for the entry table and names
+	const std::unique_ptr<u128[]> buf(new u128[std::max<u64>(BUF_SIZE, sizeof(PKGEntry) * header.file_count) / sizeof(u128)]);
+
+	// Define decryption subfunction (`psp` arg selects the key for specific block)
+	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	{
+		// Read the data and set available size
+		const u64 read = archive_read_at(header.data_offset + offset, buf.get(), size);
+
+		decrypt_buf(offset, read, key, buf.get());
 
 		// Return the amount of data written in buf
 		return read;
@@ -306,8 +361,163 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 
 	std::memcpy(entries.data(), buf.get(), entries.size() * sizeof(PKGEntry));
 
+	// Output file shared by its pending chunks (closed after the last one is written)
+	struct pkg_out_file
+	{
+		fs::file file;
+		std::string path;
+		atomic_t<bool> failed{false};
+
+		// Serializes writes if the file doesn't support positional I/O natively
+		bool positional = false;
+		std::mutex mutex;
+	};
+
+	// Part of the file processed by a worker: read, decrypt, write
+	struct pkg_chunk
+	{
+		std::shared_ptr<pkg_out_file> out;
+		u64 offset; // Offset in the data area
+		u64 pos; // Offset in the output file
+		u64 size;
+		const uchar* key;
+	};
+
+	shared_mutex queue_mutex;
+	cond_variable queue_cond;
+	std::deque<pkg_chunk> queue;
+	u32 in_flight = 0;
+	bool queue_end = false;
+
+	// Installation state shared with the workers
+	atomic_t<bool> cancelled{false};
+	atomic_t<bool> failed{false};
+	atomic_t<bool> cancel_ignored{false};
+	atomic_t<u64> bytes_written{0};
+
+	const auto start_time = std::chrono::steady_clock::now();
+
+	auto worker = [&]
+	{
+		const std::unique_ptr<u128[]> data(new u128[PKG_CHUNK_SIZE / sizeof(u128)]);
+
+		while (true)
+		{
+			pkg_chunk chunk;
+			{
+				std::unique_lock lock(queue_mutex);
+
+				while (queue.empty() && !queue_end)
+				{
+					queue_cond.wait(queue_mutex);
+				}
+
+				if (queue.empty())
+				{
+					return;
+				}
+
+				chunk = std::move(queue.front());
+				queue.pop_front();
+			}
+
+			if (!cancelled && !failed && !chunk.out->failed)
+			{
+				try
+				{
+					if (archive_read_at(header.data_offset + chunk.offset, data.get(), chunk.size) != chunk.size)
+					{
+						LOG_ERROR(LOADER, "Failed to extract file %s", chunk.out->path);
+						chunk.out->failed = true;
+					}
+					else
+					{
+						decrypt_buf(chunk.offset, chunk.size, chunk.key, data.get());
+
+						std::unique_lock<std::mutex> lock;
+
+						if (!chunk.out->positional)
+						{
+							lock = std::unique_lock(chunk.out->mutex);
+						}
+
+						if (chunk.out->file.write_at(chunk.pos, data.get(), chunk.size) != chunk.size)
+						{
+							LOG_ERROR(LOADER, "Failed to write file %s", chunk.out->path);
+							chunk.out->failed = true;
+						}
+						else
+						{
+							bytes_written += chunk.size;
+						}
+					}
+				}
+				catch (const std::exception& e)
+				{
+					// Abort the installation (the exception would otherwise terminate the process)
+					LOG_ERROR(LOADER, "Failed to install file %s: %s", chunk.out->path, e.what());
+					chunk.out->failed = true;
+					failed = true;
+				}
+
+				if (sync.fetch_add((chunk.size + 0.0) / header.data_size) < 0.)
+				{
+					if (was_null)
+					{
+						cancelled = true;
+					}
+					else if (!cancel_ignored.exchange(true))
+					{
+						// Cannot cancel the installation
+						sync += 1.;
+					}
+				}
+			}
+
+			// Release the file before notifying the producer
+			chunk.out.reset();
+
+			std::lock_guard{queue_mutex}, in_flight--;
+			queue_cond.notify_all();
+		}
+	};
+
+	// Start workers (each one reads, decrypts and writes its own chunks, so disk I/O overlaps with decryption)
+	std::vector<std::unique_ptr<named_thread<decltype(worker)>>> workers;
+
+	const u32 worker_count = std::clamp<u32>(std::thread::hardware_concurrency(), 2, 8);
+
+	for (u32 i = 0; i < worker_count; i++)
+	{
+		workers.emplace_back(std::make_unique<named_thread<decltype(worker)>>(fmt::format("PKG Worker %u", i), decltype(worker)(worker)));
+	}
+
+	// Add chunk to the queue, limits the amount of pending chunks (and opened files)
+	auto enqueue = [&](pkg_chunk&& chunk)
+	{
+		std::unique_lock lock(queue_mutex);
+
+		while (in_flight >= PKG_MAX_PENDING)
+		{
+			queue_cond.wait(queue_mutex);
+		}
+
+		in_flight++;
+		queue.emplace_back(std::move(chunk));
+		lock.unlock();
+		queue_cond.notify_all();
+	};
+
+	// Output files which may still have pending chunks
+	std::unordered_map<std::string, std::weak_ptr<pkg_out_file>> out_files;
+
 	for (const auto& entry : entries)
 	{
+		if (cancelled || failed)
+		{
+			break;
+		}
+
 		const bool is_psp = (entry.type & PKG_FILE_ENTRY_PSP) != 0;
 
 		if (entry.name_size > 256)
@@ -346,37 +556,28 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 				break;
 			}
 
-			if (fs::file out{path, fs::rewrite})
+			// If the package contains the path twice, let the previous chunks be written before truncating the file
+			if (const auto found = out_files.find(path); found != out_files.end())
 			{
-				for (u64 pos = 0; pos < entry.file_size; pos += BUF_SIZE)
-				{
-					const u64 block_size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
-
-					if (decrypt(entry.file_offset + pos, block_size, is_psp ? PKG_AES_KEY2 : dec_key.data()) != block_size)
-					{
-						LOG_ERROR(LOADER, "Failed to extract file %s", path);
-						break;
-					}
+				std::unique_lock lock(queue_mutex);
 
-					if (out.write(buf.get(), block_size) != block_size)
-					{
-						LOG_ERROR(LOADER, "Failed to write file %s", path);
-						break;
-					}
+				while (!found->second.expired())
+				{
+					queue_cond.wait(queue_mutex);
+				}
+			}
 
-					if (sync.fetch_add((block_size + 0.0) / header.data_size) < 0.)
-					{
-						if (was_null)
-						{
-							LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
-							out.close();
-							fs::remove_all(dir, true);
-							return false;
-						}
+			if (fs::file out{path, fs::rewrite})
+			{
+				const auto file = std::make_shared<pkg_out_file>();
+				file->file = std::move(out);
+				file->path = path;
+				file->positional = file->file.positional_io();
+				out_files[path] = file;
 
-						// Cannot cancel the installation
-						sync += 1.;
-					}
+				for (u64 pos = 0; pos < entry.file_size; pos += PKG_CHUNK_SIZE)
+				{
+					enqueue(pkg_chunk{file, entry.file_offset + pos, pos, std::min<u64>(PKG_CHUNK_SIZE, entry.file_size - pos), is_psp ? PKG_AES_KEY2 : dec_key.data()});
 				}
 
 				if (did_overwrite)
@@ -424,6 +625,26 @@ bool pkg_install(const std::string& path, atomic_t<double>& sync)
 		}
 	}
 
-	LOG_SUCCESS(LOADER, "Package successfully installed to %s", dir);
+	// Wait for the workers to finish all chunks
+	std::lock_guard{queue_mutex}, queue_end = true;
+	queue_cond.notify_all();
+	workers.clear();
+
+	if (cancelled)
+	{
+		LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
+		fs::remove_all(dir, true);
+		return false;
+	}
+
+	if (failed)
+	{
+		LOG_ERROR(LOADER, "Package installation failed: %s", dir);
+		return false;
+	}
+
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	LOG_SUCCESS(LOADER, "Package successfully installed to %s (%.2f MB in %.2f s, %.2f MB/s)", dir, bytes_written / 1048576., elapsed, elapsed > 0. ? bytes_written / 1048576. / elapsed : 0.);
 	return true;
 }
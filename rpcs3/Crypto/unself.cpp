@@ -1374,6 +1374,115 @@ static bool CheckDebugSelf(fs::file& s)
 	return false;
 }
 
+// Decrypted SELF cache file header
+struct self_cache_header
+{
+	u64 magic;
+	u64 size; // ELF size
+	u8 hash[20]; // ELF SHA-1
+	u32 reserved;
+};
+
+static constexpr u64 s_self_cache_magic = "RPCSELF1"_u64;
+
+static std::string get_self_cache_path(const fs::file& self, const u8* klic_key)
+{
+	sha1_context ctx;
+	sha1_starts(&ctx);
+
+	std::vector<u8> buf(0x100000);
+
+	for (u64 pos = 0; const u64 size = self.read_at(pos, buf.data(), buf.size()); pos += size)
+	{
+		sha1_update(&ctx, buf.data(), size);
+	}
+
+	if (klic_key)
+	{
+		// Decryption of NPDRM executables depends on the license
+		sha1_update(&ctx, klic_key, 0x10);
+	}
+
+	u8 hash[20];
+	sha1_finish(&ctx, hash);
+
+	return fmt::format("%scache/self/%s.elf", fs::get_cache_dir(), fmt::base57(hash));
+}
+
+static fs::file load_self_cache(const std::string& path)
+{
+	const fs::file cache(path);
+
+	if (!cache)
+	{
+		return fs::file{};
+	}
+
+	self_cache_header hdr;
+
+	if (!cache.read(hdr) || hdr.magic != s_self_cache_magic || hdr.size != cache.size() - sizeof(hdr))
+	{
+		LOG_WARNING(LOADER, "SELF: Invalid cache file header (%s)", path);
+		return fs::file{};
+	}
+
+	std::vector<u8> data(hdr.size);
+
+	if (cache.read(data.data(), data.size()) != data.size())
+	{
+		LOG_WARNING(LOADER, "SELF: Failed to read cache file (%s)", path);
+		return fs::file{};
+	}
+
+	u8 hash[20];
+	sha1(data.data(), data.size(), hash);
+
+	if (std::memcmp(hash, hdr.hash, sizeof(hash)) != 0)
+	{
+		LOG_WARNING(LOADER, "SELF: Cache file is corrupted (%s)", path);
+		return fs::file{};
+	}
+
+	LOG_NOTICE(LOADER, "SELF: Loaded decrypted executable from cache (%s)", path);
+	return fs::make_stream(std::move(data));
+}
+
+static void save_self_cache(const std::string& path, const fs::file& elf)
+{
+	const std::vector<u8> data = elf.to_vector<u8>();
+
+	self_cache_header hdr{};
+	hdr.magic = s_self_cache_magic;
+	hdr.size = data.size();
+	sha1(data.data(), data.size(), hdr.hash);
+
+	if (!fs::create_path(path.substr(0, path.find_last_of('/'))))
+	{
+		LOG_ERROR(LOADER, "SELF: Failed to create cache directory for %s (%s)", path, fs::g_tls_error);
+		return;
+	}
+
+	// Write a temporary file first so that concurrent loaders never see a partial entry
+	static atomic_t<u32> s_tmp_id{0};
+
+	const std::string tmp = fmt::format("%s.%u.tmp", path, s_tmp_id++);
+
+	if (fs::file out{tmp, fs::rewrite})
+	{
+		const bool ok = out.write(&hdr, sizeof(hdr)) == sizeof(hdr) && out.write(data.data(), data.size()) == data.size();
+
+		out.close();
+
+		if (ok && fs::rename(tmp, path, true))
+		{
+			return;
+		}
+	}
+
+	LOG_ERROR(LOADER, "SELF: Failed to write cache file %s (%s)", path, fs::g_tls_error);
+	fs::remove_file(tmp);
+}
+
 extern fs::file decrypt_self(fs::file elf_or_self, u8* klic_key)
 {
 	if (!elf_or_self)
@@ -1386,6 +1495,18 @@ extern fs::file decrypt_self(fs::file elf_or_self, u8* klic_key)
 	// Check SELF header first. Check for a debug SELF.
 	if (elf_or_self.size() >= 4 && elf_or_self.read<u32>() == "SCE\0"_u32 && !CheckDebugSelf(elf_or_self))
 	{
+		std::string cache_path;
+
+		if (g_cfg.core.self_cache)
+		{
+			cache_path = get_self_cache_path(elf_or_self, klic_key);
+
+			if (fs::file elf = load_self_cache(cache_path))
+			{
+				return elf;
+			}
+		}
+
 		// Check the ELF file class (32 or 64 bit).
 		bool isElf32 = IsSelfElf32(elf_or_self);
 
@@ -1414,7 +1535,14 @@ extern fs::file decrypt_self(fs::file elf_or_self, u8* klic_key)
 		}
 
 		// Make a new ELF file from this SELF.
-		return self_dec.MakeElf(isElf32);
+		fs::file elf = self_dec.MakeElf(isElf32);
+
+		if (!cache_path.empty())
+		{
+			save_self_cache(cache_path, elf);
+		}
+
+		return elf;
 	}
 
 	return elf_or_self;
@@ -28,15 +28,15 @@ ALSABackend::ALSABackend()
 
 ALSABackend::~ALSABackend()
 {
-	if (tls_sw_params || tls_hw_params || tls_handle)
-	{
-		Close();
-	}
+	Close();
 }
 
 void ALSABackend::Open(u32 num_buffers)
 {
-	if (!check(snd_pcm_open(&tls_handle, "default", SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK), "snd_pcm_open"))
+	// Blocking mode, the data is written from the feeder thread
+	StartRing(num_buffers);
+
+	if (!check(snd_pcm_open(&tls_handle, "default", SND_PCM_STREAM_PLAYBACK, 0), "snd_pcm_open"))
 		return;
 
 	if (!check(snd_pcm_hw_params_malloc(&tls_hw_params), "snd_pcm_hw_params_malloc"))
@@ -108,6 +108,8 @@ void ALSABackend::Open(u32 num_buffers)
 
 void ALSABackend::Close()
 {
+	StopRing();
+
 	if (tls_sw_params)
 	{
 		snd_pcm_sw_params_free(tls_sw_params);
@@ -127,32 +129,30 @@ void ALSABackend::Close()
 	}
 }
 
-bool ALSABackend::AddData(const void* src, u32 num_samples)
+bool ALSABackend::WriteDevice(const void* src, u32 size)
 {
-	u32 num_frames = num_samples / get_channels();
-
-	int res = snd_pcm_writei(tls_handle, src, num_frames);
-
-	if (res == -EAGAIN)
+	if (!tls_handle)
 	{
-		LOG_WARNING(GENERAL, "ALSA: EAGAIN");
 		return false;
 	}
 
-	if (false)
+	const snd_pcm_uframes_t num_frames = size / (get_channels() * get_sample_size());
+
+	snd_pcm_sframes_t res = snd_pcm_writei(tls_handle, src, num_frames);
+
+	if (res == -EPIPE || res == -ESTRPIPE || res == -EINTR)
 	{
-		res = snd_pcm_recover(tls_handle, res, 0);
+		LOG_WARNING(GENERAL, "ALSA: recovering from %s", snd_strerror(static_cast<int>(res)));
 
-		if (res < 0)
+		if (!check(snd_pcm_recover(tls_handle, static_cast<int>(res), 1), "snd_pcm_recover"))
 		{
-			LOG_WARNING(GENERAL, "ALSA: failed to recover (%d)", res);
 			return false;
 		}
 
 		res = snd_pcm_writei(tls_handle, src, num_frames);
 	}
 
-	if (res != num_frames)
+	if (res < 0 || static_cast<snd_pcm_uframes_t>(res) != num_frames)
 	{
 		LOG_WARNING(GENERAL, "ALSA: error (%d)", res);
 		return false;
@@ -161,4 +161,25 @@ bool ALSABackend::AddData(const void* src, u32 num_samples)
 	return true;
 }
 
+u64 ALSABackend::GetDeviceDelay()
+{
+	snd_pcm_sframes_t delay = 0;
+
+	if (!tls_handle || snd_pcm_delay(tls_handle, &delay) < 0 || delay < 0)
+	{
+		return 0;
+	}
+
+	return delay * 1'000'000ull / get_sampling_rate();
+}
+
+void ALSABackend::FlushDevice()
+{
+	if (tls_handle)
+	{
+		check(snd_pcm_drop(tls_handle), "snd_pcm_drop");
+		check(snd_pcm_prepare(tls_handle), "snd_pcm_prepare");
+	}
+}
+
 #endif
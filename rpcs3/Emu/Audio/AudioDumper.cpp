@@ -1,32 +1,437 @@
 ﻿#include "stdafx.h"
 #include "AudioDumper.h"
+#include "Emu/System.h"
 
+#include <cmath>
+
+extern "C"
+{
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+extern std::mutex g_mutex_avcodec_open2;
+
+// Output file of the audio dumper
+class audio_dump_file
+{
+public:
+	virtual ~audio_dump_file() = default;
+
+	// Write interleaved float frames
+	virtual void write(const float* data, u32 frames) = 0;
+
+	// Current file size in bytes
+	virtual u64 size() const = 0;
+};
+
+namespace
+{
+	constexpr u32 dump_rate = 48000;
+
+	class wav_file final : public audio_dump_file
+	{
+		WAVHeader m_header;
+		fs::file m_output;
+
+	public:
+		wav_file(const std::string& path, u16 ch)
+			: m_header(ch)
+		{
+			if (!m_output.open(path, fs::rewrite))
+			{
+				LOG_ERROR(GENERAL, "AudioDumper: failed to open '%s' (%s)", path, fs::g_tls_error);
+				return;
+			}
+
+			m_output.write(m_header); // write initial file header
+		}
+
+		~wav_file() override
+		{
+			if (m_output)
+			{
+				m_output.seek(0);
+				m_output.write(m_header); // rewrite file header
+			}
+		}
+
+		void write(const float* data, u32 frames) override
+		{
+			if (m_output)
+			{
+				const u32 size = frames * m_header.FMT.BlockAlign;
+				verify(HERE), m_output.write(data, size) == size;
+				m_header.Size += size;
+				m_header.RIFF.Size += size;
+			}
+		}
+
+		u64 size() const override
+		{
+			return sizeof(m_header) + m_header.Size;
+		}
+	};
+
+	// FLAC has no float sample format, the samples are stored as 24 bit
+	class flac_file final : public audio_dump_file
+	{
+		AVFormatContext* m_format = nullptr;
+		AVCodecContext* m_ctx = nullptr;
+		AVStream* m_stream = nullptr;
+		AVFrame* m_frame = nullptr;
+
+		const u16 m_ch;
+
+		// Frames stored in m_frame
+		u32 m_pending = 0;
+
+		s64 m_pts = 0;
+
+		bool m_ok = false;
+
+		bool encode(AVFrame* frame)
+		{
+			if (avcodec_send_frame(m_ctx, frame) < 0)
+			{
+				return false;
+			}
+
+			while (true)
+			{
+				AVPacket packet;
+				av_init_packet(&packet);
+				packet.data = nullptr;
+				packet.size = 0;
+
+				const int err = avcodec_receive_packet(m_ctx, &packet);
+
+				if (err == AVERROR(EAGAIN) || err == AVERROR_EOF)
+				{
+					return true;
+				}
+
+				if (err < 0)
+				{
+					return false;
+				}
+
+				av_packet_rescale_ts(&packet, m_ctx->time_base, m_stream->time_base);
+				packet.stream_index = m_stream->index;
+
+				// Takes the ownership of the packet
+				if (av_interleaved_write_frame(m_format, &packet) < 0)
+				{
+					return false;
+				}
+			}
+		}
+
+	public:
+		flac_file(const std::string& path, u16 ch)
+			: m_ch(ch)
+		{
+			av_register_all();
+			avcodec_register_all();
+
+			const auto fail = [&](const char* what, int err)
+			{
+				LOG_ERROR(GENERAL, "AudioDumper: %s failed (err=0x%x, path='%s')", what, err, path);
+			};
+
+			AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_FLAC);
+
+			if (!codec)
+			{
+				fail("avcodec_find_encoder(FLAC)", 0);
+				return;
+			}
+
+			if (int err = avformat_alloc_output_context2(&m_format, nullptr, "flac", path.c_str()); err < 0)
+			{
+				fail("avformat_alloc_output_context2()", err);
+				return;
+			}
+
+			m_ctx = avcodec_alloc_context3(codec);
+
+			if (!m_ctx)
+			{
+				fail("avcodec_alloc_context3()", 0);
+				return;
+			}
+
+			m_ctx->sample_fmt = AV_SAMPLE_FMT_S32;
+			m_ctx->bits_per_raw_sample = 24;
+			m_ctx->sample_rate = dump_rate;
+			m_ctx->channels = ch;
+			m_ctx->channel_layout = av_get_default_channel_layout(ch);
+			m_ctx->time_base = {1, static_cast<int>(dump_rate)};
+
+			if (m_format->oformat->flags & AVFMT_GLOBALHEADER)
+			{
+				m_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+			}
+
+			{
+				std::lock_guard lock(g_mutex_avcodec_open2);
+
+				if (int err = avcodec_open2(m_ctx, codec, nullptr); err < 0)
+				{
+					fail("avcodec_open2()", err);
+					return;
+				}
+			}
+
+			m_stream = avformat_new_stream(m_format, nullptr);
+
+			if (!m_stream)
+			{
+				fail("avformat_new_stream()", 0);
+				return;
+			}
+
+			m_stream->time_base = m_ctx->time_base;
+
+			if (int err = avcodec_parameters_from_context(m_stream->codecpar, m_ctx); err < 0)
+			{
+				fail("avcodec_parameters_from_context()", err);
+				return;
+			}
+
+			if (int err = avio_open(&m_format->pb, path.c_str(), AVIO_FLAG_WRITE); err < 0)
+			{
+				fail("avio_open()", err);
+				return;
+			}
+
+			if (int err = avformat_write_header(m_format, nullptr); err < 0)
+			{
+				fail("avformat_write_header()", err);
+				return;
+			}
+
+			m_frame = av_frame_alloc();
+
+			if (!m_frame)
+			{
+				fail("av_frame_alloc()", 0);
+				return;
+			}
+
+			m_frame->nb_samples = m_ctx->frame_size;
+			m_frame->format = m_ctx->sample_fmt;
+			m_frame->channels = ch;
+			m_frame->channel_layout = m_ctx->channel_layout;
+
+			if (int err = av_frame_get_buffer(m_frame, 0); err < 0)
+			{
+				fail("av_frame_get_buffer()", err);
+				return;
+			}
+
+			m_ok = true;
+		}
+
+		~flac_file() override
+		{
+			if (m_ok)
+			{
+				if (m_pending)
+				{
+					// Short last frame
+					m_frame->nb_samples = m_pending;
+					m_frame->pts = m_pts;
+					encode(m_frame);
+				}
+
+				encode(nullptr);
+				av_write_trailer(m_format);
+			}
+
+			if (m_format)
+			{
+				if (m_format->pb)
+				{
+					avio_closep(&m_format->pb);
+				}
+
+				avformat_free_context(m_format);
+			}
+
+			avcodec_free_context(&m_ctx);
+			av_frame_free(&m_frame);
+		}
+
+		bool ok() const
+		{
+			return m_ok;
+		}
+
+		void write(const float* data, u32 frames) override
+		{
+			while (m_ok && frames)
+			{
+				if (m_pending == 0 && av_frame_make_writable(m_frame) < 0)
+				{
+					m_ok = false;
+					break;
+				}
+
+				const u32 count = std::min<u32>(frames, m_ctx->frame_size - m_pending);
+
+				s32* dst = reinterpret_cast<s32*>(m_frame->data[0]) + m_pending * m_ch;
+
+				for (u32 i = 0; i < count * m_ch; i++)
+				{
+					// NaN is stored as silence (converting it to an integer is undefined)
+					const f32 sample = std::isnan(data[i]) ? 0.f : std::clamp(data[i], -1.f, 1.f);
+
+					// 24 bit samples in the upper bits
+					dst[i] = static_cast<s32>(sample * 8388607.f) * 256;
+				}
+
+				data += count * m_ch;
+				frames -= count;
+				m_pending += count;
+
+				if (m_pending == static_cast<u32>(m_ctx->frame_size))
+				{
+					m_frame->pts = m_pts;
+					m_pts += m_pending;
+					m_pending = 0;
+
+					if (!encode(m_frame))
+					{
+						LOG_ERROR(GENERAL, "AudioDumper: FLAC encoding failed");
+						m_ok = false;
+					}
+				}
+			}
+		}
+
+		u64 size() const override
+		{
+			return m_format && m_format->pb ? avio_tell(m_format->pb) : 0;
+		}
+	};
+}
 
 AudioDumper::AudioDumper(u16 ch)
-	: m_header(ch)
+	: m_ch(ch)
+	, m_ring(ch * sizeof(float) * dump_rate)
 {
 	if (GetCh())
 	{
-		m_output.open(fs::get_cache_dir() + "audio.wav", fs::rewrite);
-		m_output.write(m_header); // write initial file header
+		open_file();
+
+		m_thread = std::make_unique<named_thread<writer>>("Audio Dumper", writer{this});
 	}
 }
 
 AudioDumper::~AudioDumper()
 {
-	if (GetCh())
+	// The writer drains the ring before it exits
+	m_thread.reset();
+	m_file.reset();
+
+	if (const u64 dropped = m_dropped)
 	{
-		m_output.seek(0);
-		m_output.write(m_header); // rewrite file header
+		LOG_WARNING(GENERAL, "AudioDumper: %u blocks were dropped", dropped);
 	}
 }
 
-void AudioDumper::WriteData(const void* buffer, u32 size)
+void AudioDumper::open_file()
 {
-	if (GetCh())
+	// Finalize the previous file first
+	m_file.reset();
+
+	std::string path = fs::get_cache_dir() + "audio";
+
+	if (m_index)
+	{
+		fmt::append(path, "_%u", m_index);
+	}
+
+	m_index++;
+
+	if (g_cfg.audio.dump_compressed)
+	{
+		auto file = std::make_unique<flac_file>(path + ".flac", m_ch);
+
+		if (file->ok())
+		{
+			m_file = std::move(file);
+			return;
+		}
+
+		LOG_ERROR(GENERAL, "AudioDumper: FLAC output is not available, falling back to WAV");
+	}
+
+	m_file = std::make_unique<wav_file>(path + ".wav", m_ch);
+}
+
+void AudioDumper::WriteData(const void* buffer, u32 size, bool s16)
+{
+	if (!GetCh())
+	{
+		return;
+	}
+
+	if (s16)
+	{
+		// The files are always written from float samples
+		const u32 count = size / sizeof(s16);
+		const auto src = static_cast<const s16*>(buffer);
+
+		m_convert.resize(count);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			m_convert[i] = src[i] / 32768.f;
+		}
+
+		buffer = m_convert.data();
+		size = count * sizeof(float);
+	}
+
+	if (!m_ring.push(buffer, size, 0))
 	{
-		verify(HERE), size, m_output.write(buffer, size) == size;
-		m_header.Size += size;
-		m_header.RIFF.Size += size;
+		m_dropped++;
+	}
+}
+
+void AudioDumper::writer::operator()()
+{
+	const u32 frame_size = dumper->m_ch * sizeof(float);
+	const u64 rotation_size = g_cfg.audio.dump_rotation_size * 0x100000ull;
+
+	std::vector<float> buf(AUDIO_BUFFER_SAMPLES * 16 * dumper->m_ch);
+
+	while (true)
+	{
+		// Check the state first to not lose data pushed before aborting
+		const bool stop = thread_ctrl::state() == thread_state::aborting;
+
+		u64 time;
+
+		if (const u32 size = dumper->m_ring.pop(buf.data(), ::size32(buf) * sizeof(float), time))
+		{
+			dumper->m_file->write(buf.data(), size / frame_size);
+
+			if (rotation_size && dumper->m_file->size() >= rotation_size)
+			{
+				dumper->open_file();
+			}
+
+			continue;
+		}
+
+		if (stop)
+		{
+			break;
+		}
+
+		thread_ctrl::wait_for(10000);
 	}
 }
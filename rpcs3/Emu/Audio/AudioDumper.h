@@ -2,6 +2,9 @@
 
 #include "Utilities/types.h"
 #include "Utilities/File.h"
+#include "Emu/Audio/AudioRing.h"
+
+#include <vector>
 
 struct WAVHeader
 {
@@ -61,15 +64,42 @@ struct WAVHeader
 	}
 };
 
+class audio_dump_file;
+
+// Records the audio output on a background thread (WAV or FLAC, optionally split by size)
 class AudioDumper
 {
-	WAVHeader m_header;
-	fs::file m_output;
-	
+	struct writer
+	{
+		AudioDumper* const dumper;
+
+		void operator()();
+	};
+
+	const u16 m_ch;
+
+	// Blocks handed over by the audio thread
+	audio_ring m_ring;
+
+	std::unique_ptr<audio_dump_file> m_file;
+
+	u32 m_index = 0;
+
+	// Blocks lost because the writer fell behind
+	atomic_t<u64> m_dropped{0};
+
+	// s16 input converted to float (audio thread)
+	std::vector<float> m_convert;
+
+	std::unique_ptr<named_thread<writer>> m_thread;
+
+	void open_file();
+
 public:
 	AudioDumper(u16 ch);
 	~AudioDumper();
 
-	void WriteData(const void* buffer, u32 size);
-	const u16 GetCh() const { return m_header.FMT.NumChannels; }
+	// Never blocks, the data is dropped if the writer can't keep up (samples are float or s16)
+	void WriteData(const void* buffer, u32 size, bool s16);
+	const u16 GetCh() const { return m_ch; }
 };
@@ -0,0 +1,100 @@
+﻿#include "stdafx.h"
+#include "AudioResampler.h"
+
+#include <cmath>
+
+namespace
+{
+	// Number of history frames kept between blocks
+	constexpr u32 history = 3;
+
+	inline float to_float(float v)
+	{
+		return v;
+	}
+
+	inline float to_float(s16 v)
+	{
+		return v * (1.0f / 0x8000);
+	}
+
+	inline void from_float(float v, float& out)
+	{
+		out = v;
+	}
+
+	inline void from_float(float v, s16& out)
+	{
+		out = static_cast<s16>(std::lrint(std::clamp(v * 0x8000, -32768.0f, 32767.0f)));
+	}
+}
+
+AudioResampler::AudioResampler(u32 channels)
+	: m_channels(channels)
+{
+	reset();
+}
+
+void AudioResampler::reset()
+{
+	m_buffer.assign(history * m_channels, 0.0f);
+	m_pos = 1.0;
+}
+
+template <typename T>
+u32 AudioResampler::process_impl(const T* in, u32 frames, f32 ratio)
+{
+	const u32 ch = m_channels;
+
+	// Append the block after the history
+	m_buffer.resize((history + frames) * ch);
+
+	for (u32 i = 0; i < frames * ch; i++)
+	{
+		m_buffer[history * ch + i] = to_float(in[i]);
+	}
+
+	// Every output frame needs one frame before and two frames after the position
+	const u32 out_max = static_cast<u32>((frames + 1) / ratio) + 2;
+	m_output.resize(out_max * ch * sizeof(T));
+
+	T* out = reinterpret_cast<T*>(m_output.data());
+	u32 count = 0;
+
+	for (; count < out_max && m_pos < frames + 1; count++, m_pos += ratio)
+	{
+		const u32 i = static_cast<u32>(m_pos);
+		const float t = static_cast<float>(m_pos - i);
+
+		const float* x = &m_buffer[(i - 1) * ch];
+
+		for (u32 c = 0; c < ch; c++)
+		{
+			const float xm1 = x[c];
+			const float x0 = x[c + ch];
+			const float x1 = x[c + ch * 2];
+			const float x2 = x[c + ch * 3];
+
+			const float v = x0 + 0.5f * t * (x1 - xm1 + t * (2.0f * xm1 - 5.0f * x0 + 4.0f * x1 - x2 + t * (3.0f * (x0 - x1) + x2 - xm1)));
+
+			from_float(v, out[count * ch + c]);
+		}
+	}
+
+	// Keep the last frames as the history of the next block
+	std::copy(m_buffer.end() - history * ch, m_buffer.end(), m_buffer.begin());
+	m_buffer.resize(history * ch);
+	m_pos -= frames;
+
+	return count;
+}
+
+u32 AudioResampler::process(const void* in, u32 frames, f32 ratio, bool s16)
+{
+	if (s16)
+	{
+		return process_impl(static_cast<const ::s16*>(in), frames, ratio);
+	}
+
+	return process_impl(static_cast<const float*>(in), frames, ratio);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Utilities/types.h"
+
+#include <vector>
+
+// Streaming cubic (Catmull-Rom) resampler for interleaved audio, used for time stretching if the backend can't change its frequency ratio
+class AudioResampler
+{
+	const u32 m_channels;
+
+	// Last frames of the previous block followed by the current block (float samples)
+	std::vector<float> m_buffer;
+
+	// Read position in m_buffer (frames)
+	double m_pos = 1.0;
+
+	// Resampled output
+	std::vector<u8> m_output;
+
+	template <typename T>
+	u32 process_impl(const T* in, u32 frames, f32 ratio);
+
+public:
+	AudioResampler(u32 channels);
+
+	// Discard history (call when the stream is interrupted)
+	void reset();
+
+	// Resample the block of interleaved float or s16 (if s16 is set) frames
+	// ratio < 1.0 stretches the block, returns the number of output frames
+	u32 process(const void* in, u32 frames, f32 ratio, bool s16);
+
+	const void* data() const
+	{
+		return m_output.data();
+	}
+};
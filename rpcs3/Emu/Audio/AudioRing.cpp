@@ -0,0 +1,259 @@
+﻿#include "stdafx.h"
+#include "AudioRing.h"
+
+audio_ring_stats g_audio_ring_stats;
+
+audio_ring::audio_ring(u32 capacity)
+	: m_size(std::max<u32>(1u << ::ceil2(capacity), 256))
+{
+	m_data.reset(new u8[m_size]);
+}
+
+bool audio_ring::push(const void* src, u32 size, u64 time)
+{
+	const u64 write = m_write.load();
+	const u64 stamp = m_stamp_write.load();
+
+	if (write + size - m_read.load() > m_size || stamp - m_stamp_read.load() >= max_stamps)
+	{
+		return false;
+	}
+
+	const u32 pos = static_cast<u32>(write) & (m_size - 1);
+	const u32 first = std::min(size, m_size - pos);
+
+	std::memcpy(m_data.get() + pos, src, first);
+	std::memcpy(m_data.get(), static_cast<const u8*>(src) + first, size - first);
+
+	auto& entry = m_stamps[stamp % max_stamps];
+	entry.end = write + size;
+	entry.time = time;
+
+	// Publish the data before the stamp can be observed as completed
+	m_write.release(write + size);
+	m_stamp_write.release(stamp + 1);
+	return true;
+}
+
+u32 audio_ring::pop(void* dst, u32 max_size, u64& time)
+{
+	time = 0;
+
+	const u64 read = m_read.load();
+	const u32 size = static_cast<u32>(std::min<u64>(m_write.load() - read, max_size));
+
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	const u32 pos = static_cast<u32>(read) & (m_size - 1);
+	const u32 first = std::min(size, m_size - pos);
+
+	std::memcpy(dst, m_data.get() + pos, first);
+	std::memcpy(static_cast<u8*>(dst) + first, m_data.get(), size - first);
+
+	// Data may have been overwritten after a concurrent clear()
+	if (!m_read.compare_and_swap_test(read, read + size))
+	{
+		return 0;
+	}
+
+	// Retire the blocks which were consumed completely
+	const u64 first_stamp = m_stamp_read.load();
+
+	u64 stamp = first_stamp;
+	u64 last = 0;
+
+	while (stamp != m_stamp_write.load() && m_stamps[stamp % max_stamps].end.load() <= read + size)
+	{
+		last = m_stamps[stamp % max_stamps].time.load();
+		stamp++;
+	}
+
+	// The entries are only valid if no clear() happened meanwhile
+	if (stamp != first_stamp && m_stamp_read.compare_and_swap_test(first_stamp, stamp))
+	{
+		time = last;
+	}
+
+	return size;
+}
+
+void audio_ring::clear()
+{
+	m_read = m_write.load();
+	m_stamp_read = m_stamp_write.load();
+}
+
+void audio_ring_stats::reset()
+{
+	latency = 0;
+	latency_max = 0;
+	underruns = 0;
+
+	for (auto& v : fill)
+	{
+		v = 0;
+	}
+}
+
+void audio_ring_stats::add_latency(u64 value)
+{
+	// Single writer (feeder thread)
+	const u64 old = latency.load();
+	latency.release(old ? old - old / 8 + value / 8 : value);
+
+	if (value > latency_max.load())
+	{
+		latency_max.release(value);
+	}
+}
+
+void AudioRingBackend::feeder::operator()()
+{
+	auto& ring = *backend->m_ring;
+
+	const u32 period = AUDIO_BUFFER_SAMPLES * backend->m_frame_size;
+	const u64 block_time = AUDIO_BUFFER_SAMPLES * 1'000'000ull / get_sampling_rate();
+
+	std::unique_ptr<u8[]> buf(new u8[period]);
+
+	while (thread_ctrl::state() != thread_state::aborting)
+	{
+		if (backend->m_flush.exchange(false))
+		{
+			backend->FlushDevice();
+			backend->m_device_delay = 0;
+		}
+
+		if (!backend->m_playing)
+		{
+			thread_ctrl::wait();
+			continue;
+		}
+
+		const u32 used = ring.get_used();
+
+		u64 time;
+
+		if (const u32 size = ring.pop(buf.get(), period, time))
+		{
+			g_audio_ring_stats.fill[std::min<u64>(u64{used} * audio_ring_stats::fill_buckets / backend->m_nominal_size, audio_ring_stats::fill_buckets - 1)]++;
+
+			if (!backend->WriteDevice(buf.get(), size))
+			{
+				LOG_WARNING(GENERAL, "%s: failed to write %u bytes to the device", backend->GetName(), size);
+			}
+
+			const u64 delay = backend->GetDeviceDelay();
+			backend->m_device_delay = delay;
+
+			if (time)
+			{
+				const u64 now = get_system_time() - Emu.GetPauseTime();
+				g_audio_ring_stats.add_latency((now > time ? now - time : 0) + delay);
+			}
+
+			continue;
+		}
+
+		const u64 delay = backend->GetDeviceDelay();
+		backend->m_device_delay = delay;
+
+		if (delay < block_time / 2)
+		{
+			// Nothing left to play, report it as stopped so cellAudio can rebuffer
+			std::lock_guard lock(backend->m_mutex);
+
+			// Data pushed before a concurrent Play() must be played
+			if (!ring.get_used() && backend->m_playing)
+			{
+				g_audio_ring_stats.underruns++;
+				backend->m_playing = false;
+			}
+
+			continue;
+		}
+
+		thread_ctrl::wait_for(block_time / 4);
+	}
+}
+
+void AudioRingBackend::StartRing(u32 num_buffers)
+{
+	m_frame_size = get_channels() * get_sample_size();
+	m_nominal_size = num_buffers * AUDIO_BUFFER_SAMPLES * m_frame_size;
+
+	// Leave room for time stretched (resampled) blocks
+	m_ring = std::make_unique<audio_ring>(m_nominal_size * 2);
+
+	m_playing = false;
+	m_flush = false;
+	m_device_delay = 0;
+
+	g_audio_ring_stats.reset();
+	g_audio_ring_stats.active = true;
+
+	m_thread = std::make_unique<named_thread<feeder>>(fmt::format("%s Feeder", GetName()), feeder{this});
+}
+
+void AudioRingBackend::StopRing()
+{
+	// Joins the feeder thread
+	m_thread.reset();
+	m_ring.reset();
+
+	g_audio_ring_stats.active = false;
+}
+
+bool AudioRingBackend::AddData(const void* src, u32 num_samples)
+{
+	AUDIT(m_ring);
+
+	if (!m_ring->push(src, num_samples * get_sample_size(), get_system_time() - Emu.GetPauseTime()))
+	{
+		return false;
+	}
+
+	if (m_playing)
+	{
+		thread_ctrl::notify(*m_thread);
+	}
+
+	return true;
+}
+
+void AudioRingBackend::Play()
+{
+	std::lock_guard{m_mutex}, m_playing = true;
+	thread_ctrl::notify(*m_thread);
+}
+
+void AudioRingBackend::Pause()
+{
+	std::lock_guard{m_mutex}, m_playing = false;
+}
+
+void AudioRingBackend::Flush()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_playing = false;
+		m_ring->clear();
+	}
+
+	// Device buffers are only touched from the feeder thread
+	m_flush = true;
+	thread_ctrl::notify(*m_thread);
+}
+
+bool AudioRingBackend::IsPlaying()
+{
+	return m_playing;
+}
+
+u64 AudioRingBackend::GetNumEnqueuedSamples()
+{
+	return m_ring->get_used() / m_frame_size + m_device_delay * get_sampling_rate() / 1'000'000;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Utilities/types.h"
+#include "Utilities/Thread.h"
+#include "Utilities/mutex.h"
+#include "Emu/Audio/AudioBackend.h"
+
+#include <array>
+#include <memory>
+
+// Lock-free single producer, single consumer byte ring for audio data
+// Every pushed block is tagged with its enqueue timestamp, which the consumer reports once the block is fully consumed
+class audio_ring
+{
+	static constexpr u32 max_stamps = MAX_AUDIO_BUFFERS * 2;
+
+	// Atomic because clear() lets the producer reuse entries the consumer may still be reading (the consumer discards them)
+	struct stamp_t
+	{
+		atomic_t<u64> end; // Write position after the block
+		atomic_t<u64> time; // Enqueue timestamp
+	};
+
+	std::unique_ptr<u8[]> m_data;
+
+	const u32 m_size; // Power of 2
+
+	std::array<stamp_t, max_stamps> m_stamps{};
+
+	// Monotonic positions (bytes, stamps), written by the producer
+	alignas(64) atomic_t<u64> m_write{0};
+	atomic_t<u64> m_stamp_write{0};
+
+	// Monotonic positions, advanced by the consumer with CAS (and reset by clear())
+	alignas(64) atomic_t<u64> m_read{0};
+	atomic_t<u64> m_stamp_read{0};
+
+public:
+	explicit audio_ring(u32 capacity);
+
+	// Producer: append a block, returns false if there is no room
+	bool push(const void* src, u32 size, u64 time);
+
+	// Consumer: copy up to max_size bytes to dst, returns the amount of bytes read
+	// The timestamp of the last completed block is returned in time (0 if no block was completed)
+	u32 pop(void* dst, u32 max_size, u64& time);
+
+	// Producer: drop all queued data (a concurrent pop is discarded)
+	void clear();
+
+	u32 get_used() const
+	{
+		return static_cast<u32>(m_write - m_read);
+	}
+
+	u32 get_capacity() const
+	{
+		return m_size;
+	}
+};
+
+// Audio output telemetry (shown in the performance overlay)
+struct audio_ring_stats
+{
+	static constexpr u32 fill_buckets = 8;
+
+	atomic_t<bool> active{false};
+
+	atomic_t<u64> latency{0}; // Smoothed end-to-end latency (usecs)
+	atomic_t<u64> latency_max{0};
+	atomic_t<u64> underruns{0};
+
+	// Ring fill level relative to the requested buffer size, sampled on every pop
+	std::array<atomic_t<u64>, fill_buckets> fill{};
+
+	void reset();
+
+	void add_latency(u64 value);
+};
+
+extern audio_ring_stats g_audio_ring_stats;
+
+// Base class for backends with a blocking device API
+// The audio thread only fills the ring, a feeder thread drains it at the device cadence
+class AudioRingBackend : public AudioBackend
+{
+	struct feeder
+	{
+		AudioRingBackend* const backend;
+
+		void operator()();
+	};
+
+	std::unique_ptr<audio_ring> m_ring;
+	std::unique_ptr<named_thread<feeder>> m_thread;
+
+	// Serializes playback state changes with the feeder stopping on underrun
+	shared_mutex m_mutex;
+
+	atomic_t<bool> m_playing{false};
+	atomic_t<bool> m_flush{false};
+
+	// Device-side queued playtime reported by the feeder (usecs)
+	atomic_t<u64> m_device_delay{0};
+
+	u32 m_frame_size = 0;
+	u32 m_nominal_size = 0;
+
+protected:
+	// Write data to the device, may block (feeder thread)
+	virtual bool WriteDevice(const void* src, u32 size) = 0;
+
+	// Get the playtime of data queued in the device in usecs (feeder thread)
+	virtual u64 GetDeviceDelay()
+	{
+		return 0;
+	}
+
+	// Drop data queued in the device (feeder thread)
+	virtual void FlushDevice()
+	{
+	}
+
+	// Start the feeder thread (may precede opening the device, which isn't used until Play())
+	void StartRing(u32 num_buffers);
+
+	// Stop the feeder thread before the device is closed
+	void StopRing();
+
+public:
+	static const u32 capabilities = PLAY_PAUSE_FLUSH | IS_PLAYING | GET_NUM_ENQUEUED_SAMPLES;
+
+	virtual bool AddData(const void* src, u32 num_samples) override;
+
+	virtual void Play() override;
+	virtual void Pause() override;
+	virtual void Flush() override;
+	virtual bool IsPlaying() override;
+	virtual u64 GetNumEnqueuedSamples() override;
+};
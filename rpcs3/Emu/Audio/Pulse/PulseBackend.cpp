@@ -17,13 +17,15 @@ PulseBackend::~PulseBackend()
 
 void PulseBackend::Close()
 {
+	StopRing();
+
 	if(this->connection) {
 		pa_simple_free(this->connection);
 		this->connection = nullptr;
 	}
 }
 
-void PulseBackend::Open(u32 /* num_buffers */)
+void PulseBackend::Open(u32 num_buffers)
 {
 	pa_sample_spec ss;
 	ss.format = (get_sample_size() == 2) ? PA_SAMPLE_S16LE : PA_SAMPLE_FLOAT32LE;
@@ -51,6 +53,9 @@ void PulseBackend::Open(u32 /* num_buffers */)
 	}
 	ss.channels = channel_map.channels;
 
+	// The stream is written from the feeder thread
+	StartRing(num_buffers);
+
 	int err;
 	this->connection = pa_simple_new(NULL, "RPCS3", PA_STREAM_PLAYBACK, NULL, "Game", &ss, &channel_map, NULL, &err);
 	if(!this->connection) {
@@ -58,12 +63,14 @@ void PulseBackend::Open(u32 /* num_buffers */)
 	}
 }
 
-bool PulseBackend::AddData(const void* src, u32 num_samples)
+bool PulseBackend::WriteDevice(const void* src, u32 size)
 {
-	AUDIT(this->connection);
+	if(!this->connection) {
+		return false;
+	}
 
 	int err;
-	if(pa_simple_write(this->connection, src, num_samples * get_sample_size(), &err) < 0) {
+	if(pa_simple_write(this->connection, src, size, &err) < 0) {
 		fprintf(stderr, "PulseAudio: Failed to write audio stream: %s\n", pa_strerror(err));
 		return false;
 	}
@@ -71,4 +78,24 @@ bool PulseBackend::AddData(const void* src, u32 num_samples)
 	return true;
 }
 
+u64 PulseBackend::GetDeviceDelay()
+{
+	if(!this->connection) {
+		return 0;
+	}
+
+	int err;
+	const pa_usec_t latency = pa_simple_get_latency(this->connection, &err);
+
+	return latency == static_cast<pa_usec_t>(-1) ? 0 : latency;
+}
+
+void PulseBackend::FlushDevice()
+{
+	int err;
+	if(this->connection && pa_simple_flush(this->connection, &err) < 0) {
+		fprintf(stderr, "PulseAudio: Failed to flush audio stream: %s\n", pa_strerror(err));
+	}
+}
+
 #endif
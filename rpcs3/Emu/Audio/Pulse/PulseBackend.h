@@ -2,9 +2,9 @@
 
 #ifdef HAVE_PULSE
 #include <pulse/simple.h>
-#include "Emu/Audio/AudioBackend.h"
+#include "Emu/Audio/AudioRing.h"
 
-class PulseBackend : public AudioBackend
+class PulseBackend : public AudioRingBackend
 {
 public:
 	PulseBackend();
@@ -12,16 +12,17 @@ public:
 
 	virtual const char* GetName() const override { return "Pulse"; }
 
-	static const u32 capabilities = 0;
 	virtual u32 GetCapabilities() const override { return capabilities; }
 
 	virtual void Open(u32) override;
 	virtual void Close() override;
 
-	virtual bool AddData(const void* src, u32 num_samples) override;
-
 private:
 	pa_simple *connection = nullptr;
+
+	virtual bool WriteDevice(const void* src, u32 size) override;
+	virtual u64 GetDeviceDelay() override;
+	virtual void FlushDevice() override;
 };
 
 #endif
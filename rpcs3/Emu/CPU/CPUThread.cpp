@@ -1,5 +1,6 @@
 ﻿#include "stdafx.h"
 #include "CPUThread.h"
+#include "CPUTimeStats.h"
 
 #include "Emu/System.h"
 #include "Emu/Memory/vm_locking.h"
@@ -128,6 +129,8 @@ void cpu_thread::operator()()
 	// Register and wait if necessary
 	verify("g_cpu_array[...] -> this" HERE), g_cpu_array[array_slot].exchange(this) == nullptr;
 
+	cpu_time_stats::add_thread(*this);
+
 	state += cpu_flag::wait;
 	g_cpu_suspend_lock.lock_unlock();
 
@@ -160,6 +163,8 @@ void cpu_thread::operator()()
 		thread_ctrl::wait();
 	}
 
+	cpu_time_stats::remove_thread(*this);
+
 	// Unregister and wait if necessary
 	state += cpu_flag::wait;
 	verify("g_cpu_array[...] -> null" HERE), g_cpu_array[array_slot].exchange(nullptr) == this;
@@ -251,6 +256,11 @@ bool cpu_thread::check_state() noexcept
 				cpu_mem();
 			}
 
+			if (cpu_sleep_called)
+			{
+				cpu_wake();
+			}
+
 			break;
 		}
 		else if (!cpu_sleep_called && state0 & cpu_flag::suspend)
@@ -96,6 +96,9 @@ public:
 	// Callback for cpu_flag::suspend
 	virtual void cpu_sleep() {}
 
+	// Callback for leaving check_state() after cpu_sleep()
+	virtual void cpu_wake() {}
+
 	// Callback for cpu_flag::memory
 	virtual void cpu_mem() {}
 
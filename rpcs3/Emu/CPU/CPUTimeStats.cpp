@@ -0,0 +1,325 @@
+#include "stdafx.h"
+#include "CPUTimeStats.h"
+#include "CPUThread.h"
+
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "Utilities/mutex.h"
+
+#include <chrono>
+
+thread_local atomic_t<u32>* g_tls_cpu_activity = nullptr;
+
+namespace
+{
+	struct record
+	{
+		// Thread object, null after the thread is unregistered
+		cpu_thread* cpu;
+
+		std::string name;
+
+		u32 id;
+
+		// Current activity set by the thread itself (cpu_activity)
+		atomic_t<u32> activity{0};
+
+		// Accumulated time for each activity (nanoseconds)
+		std::array<atomic_t<u64>, cpu_time_stats::count> time{};
+	};
+
+	shared_mutex s_mutex;
+
+	// Serializes report writing with clear()
+	shared_mutex s_dump_mutex;
+
+	// All records since the emulation started (protected by s_mutex)
+	std::vector<std::unique_ptr<record>> s_records;
+
+	// Last completed sampling window for PPU and SPU threads
+	std::array<std::array<atomic_t<u64>, cpu_time_stats::count>, 2> s_recent{};
+
+	bool s_enabled = false;
+
+	u64 get_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Sampler thread context
+	struct cpu_time_sampler
+	{
+		// Sampling period (microseconds)
+		static constexpr u64 period = 1000;
+
+		// Recent window length and report interval (nanoseconds)
+		static constexpr u64 window = 1'000'000'000;
+		static constexpr u64 report = 10'000'000'000;
+
+		void operator()()
+		{
+			std::array<std::array<u64, cpu_time_stats::count>, 2> sums{};
+
+			u64 last = get_ns();
+			u64 window_start = last;
+			u64 report_start = last;
+
+			while (thread_ctrl::state() != thread_state::aborting && !Emu.IsStopped())
+			{
+				thread_ctrl::wait_for(period);
+
+				const u64 now = get_ns();
+				const u64 delta = now - std::exchange(last, now);
+
+				if (Emu.IsPaused())
+				{
+					continue;
+				}
+
+				sample(delta, sums);
+
+				if (now - window_start >= window)
+				{
+					for (u32 t = 0; t < sums.size(); t++)
+					{
+						for (u32 i = 0; i < cpu_time_stats::count; i++)
+						{
+							s_recent[t][i] = std::exchange(sums[t][i], 0);
+						}
+					}
+
+					window_start = now;
+				}
+
+				if (now - report_start >= report)
+				{
+					cpu_time_stats::dump();
+					report_start = now;
+				}
+			}
+		}
+
+		static void sample(u64 delta, std::array<std::array<u64, cpu_time_stats::count>, 2>& sums)
+		{
+			reader_lock lock(s_mutex);
+
+			for (auto& rec : s_records)
+			{
+				if (!rec->cpu)
+				{
+					continue;
+				}
+
+				const auto state = rec->cpu->state.load();
+
+				if (state & (cpu_flag::stop + cpu_flag::exit + cpu_flag::dbg_global_stop + cpu_flag::dbg_global_pause + cpu_flag::dbg_pause))
+				{
+					// Not running (idle time is not accounted)
+					continue;
+				}
+
+				// PPU threads sleeping in lv2 are marked by the scheduler
+				const u32 activity = state & cpu_flag::suspend ? static_cast<u32>(cpu_activity::lv2_wait) : rec->activity.load();
+
+				if (activity >= cpu_time_stats::count)
+				{
+					continue;
+				}
+
+				rec->time[activity] += delta;
+
+				if (const u32 type = rec->id >> 24; type - 1 < sums.size())
+				{
+					sums[type - 1][activity] += delta;
+				}
+			}
+		}
+	};
+}
+
+const char* cpu_time_stats::get_name(cpu_activity activity)
+{
+	switch (activity)
+	{
+	case cpu_activity::running: return "running";
+	case cpu_activity::lv2_wait: return "lv2_wait";
+	case cpu_activity::channel_wait: return "channel_wait";
+	case cpu_activity::reservation: return "reservation";
+	case cpu_activity::passive_lock: return "passive_lock";
+	case cpu_activity::jit: return "jit";
+	case cpu_activity::fault: return "fault";
+	case cpu_activity::__count: break;
+	}
+
+	return "unknown";
+}
+
+void cpu_time_stats::add_thread(cpu_thread& cpu)
+{
+	if (!g_cfg.core.cpu_time_accounting)
+	{
+		return;
+	}
+
+	auto rec = std::make_unique<record>();
+	rec->cpu = &cpu;
+	rec->name = cpu.get_name();
+	rec->id = cpu.id;
+
+	g_tls_cpu_activity = &rec->activity;
+
+	std::lock_guard lock(s_mutex);
+	s_records.emplace_back(std::move(rec));
+}
+
+void cpu_time_stats::remove_thread(cpu_thread& cpu)
+{
+	if (!g_tls_cpu_activity)
+	{
+		return;
+	}
+
+	g_tls_cpu_activity = nullptr;
+
+	std::lock_guard lock(s_mutex);
+
+	for (auto& rec : s_records)
+	{
+		if (rec->cpu == &cpu)
+		{
+			rec->cpu = nullptr;
+		}
+	}
+}
+
+void cpu_time_stats::start()
+{
+	s_enabled = g_cfg.core.cpu_time_accounting.get();
+
+	for (auto& arr : s_recent)
+	{
+		for (auto& val : arr)
+		{
+			val = 0;
+		}
+	}
+
+	if (s_enabled)
+	{
+		fxm::make<named_thread<cpu_time_sampler>>("CPU Time Sampler");
+	}
+}
+
+void cpu_time_stats::stop()
+{
+	// Join the sampler thread (it may be writing a periodic report)
+	fxm::withdraw<named_thread<cpu_time_sampler>>();
+}
+
+bool cpu_time_stats::is_enabled()
+{
+	return s_enabled;
+}
+
+std::vector<cpu_time_stats::entry> cpu_time_stats::collect()
+{
+	std::vector<entry> result;
+
+	{
+		reader_lock lock(s_mutex);
+
+		result.reserve(s_records.size());
+
+		for (auto& rec : s_records)
+		{
+			entry e{rec->name, rec->id, !rec->cpu};
+
+			for (u32 i = 0; i < count; i++)
+			{
+				e.time[i] = rec->time[i];
+			}
+
+			result.emplace_back(std::move(e));
+		}
+	}
+
+	std::stable_sort(result.begin(), result.end(), [](const entry& a, const entry& b)
+	{
+		return a.id < b.id;
+	});
+
+	return result;
+}
+
+std::array<u64, cpu_time_stats::count> cpu_time_stats::get_recent(u32 type)
+{
+	std::array<u64, count> result{};
+
+	if (type - 1 < s_recent.size())
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			result[i] = s_recent[type - 1][i];
+		}
+	}
+
+	return result;
+}
+
+std::string cpu_time_stats::dump(std::string path)
+{
+	if (!s_enabled)
+	{
+		return {};
+	}
+
+	if (path.empty())
+	{
+		path = fs::get_config_dir() + "cpu_time.csv";
+	}
+
+	std::lock_guard lock(s_dump_mutex);
+
+	std::string out = "type,id,name,exited,total_ms";
+
+	for (u32 i = 0; i < count; i++)
+	{
+		fmt::append(out, ",%s_ms", get_name(static_cast<cpu_activity>(i)));
+	}
+
+	out += '\n';
+
+	for (const auto& e : collect())
+	{
+		u64 total = 0;
+
+		for (u64 t : e.time)
+		{
+			total += t;
+		}
+
+		fmt::append(out, "%s,0x%x,%s,%u,%.3f", e.id >> 24 == 1 ? "ppu" : "spu", e.id, e.name, e.exited, total / 1000000.);
+
+		for (u64 t : e.time)
+		{
+			fmt::append(out, ",%.3f", t / 1000000.);
+		}
+
+		out += '\n';
+	}
+
+	if (!fs::write_file(path, fs::rewrite, out))
+	{
+		LOG_ERROR(GENERAL, "Failed to write CPU time report to '%s' (%s)", path, fs::g_tls_error);
+		return {};
+	}
+
+	return path;
+}
+
+void cpu_time_stats::clear()
+{
+	std::lock_guard dump_lock(s_dump_mutex);
+	std::lock_guard lock(s_mutex);
+	s_records.clear();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Utilities/types.h"
+#include "util/atomic.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+class cpu_thread;
+
+// Host time categories of a guest thread
+enum class cpu_activity : u32
+{
+	running, // Executing guest code or HLE functions (default)
+	lv2_wait, // Sleeping on lv2 synchronization primitive
+	channel_wait, // Waiting on SPU channel
+	reservation, // Waiting on reservation
+	passive_lock, // Blocked on vm::passive_lock
+	jit, // Compiling code
+	fault, // Handling access violation
+
+	__count
+};
+
+// Per-thread host time accounting ("CPU Time Accounting" option)
+namespace cpu_time_stats
+{
+	constexpr std::size_t count = static_cast<std::size_t>(cpu_activity::__count);
+
+	struct entry
+	{
+		std::string name;
+		u32 id;
+		bool exited;
+		std::array<u64, count> time; // Nanoseconds
+	};
+
+	const char* get_name(cpu_activity activity);
+
+	// Register the current thread (called from cpu_thread::operator(), does nothing if disabled)
+	void add_thread(cpu_thread& cpu);
+
+	// Unregister the current thread, its statistics are kept until clear()
+	void remove_thread(cpu_thread& cpu);
+
+	// Start the sampler thread (called on emulation start)
+	void start();
+
+	// Stop the sampler thread (called before the final report)
+	void stop();
+
+	bool is_enabled();
+
+	// Get statistics of all threads sorted by ID
+	std::vector<entry> collect();
+
+	// Get the breakdown of the last completed sampling window for PPU (1) or SPU (2) threads
+	std::array<u64, count> get_recent(u32 type);
+
+	// Write the report to the file (default path if empty), return the path
+	std::string dump(std::string path = {});
+
+	// Remove all records (called after all threads stopped)
+	void clear();
+}
+
+// Mark the current thread activity for the duration of the scope (no-op if accounting is disabled)
+class cpu_activity_scope
+{
+	atomic_t<u32>* const m_ptr;
+
+	u32 m_old;
+
+public:
+	cpu_activity_scope(cpu_activity activity) noexcept
+		: m_ptr([]
+		{
+			extern thread_local atomic_t<u32>* g_tls_cpu_activity;
+
+			return g_tls_cpu_activity;
+		}())
+	{
+		if (UNLIKELY(m_ptr))
+		{
+			m_old = m_ptr->exchange(static_cast<u32>(activity));
+		}
+	}
+
+	cpu_activity_scope(const cpu_activity_scope&) = delete;
+
+	cpu_activity_scope& operator=(const cpu_activity_scope&) = delete;
+
+	~cpu_activity_scope()
+	{
+		if (UNLIKELY(m_ptr))
+		{
+			m_ptr->release(m_old);
+		}
+	}
+};
@@ -16,6 +16,8 @@ extern "C"
 #include "cellPamf.h"
 #include "cellAdec.h"
 
+#include "Utilities/lockless.h"
+
 #include <mutex>
 #include <thread>
 
@@ -54,6 +56,12 @@ public:
 
 	squeue_t<AdecFrame> frames;
 
+	// Recycled AVFrame structures (decoded buffers are returned to the codec pool by av_frame_unref)
+	lf_ring<AVFrame*> frame_pool{32};
+
+	// Notified when the decoder thread finishes
+	squeue_event finished;
+
 	const s32 type;
 	const u32 memAddr;
 	const u32 memSize;
@@ -143,6 +151,10 @@ public:
 			av_frame_unref(af.data);
 			av_frame_free(&af.data);
 		}
+		for (AVFrame* frame; frame_pool.try_pop(frame);)
+		{
+			av_frame_free(&frame);
+		}
 		if (ctx)
 		{
 			avcodec_close(ctx);
@@ -159,6 +171,28 @@ public:
 		}
 	}
 
+	AVFrame* alloc_frame()
+	{
+		AVFrame* frame;
+
+		if (!frame_pool.try_pop(frame) && !(frame = av_frame_alloc()))
+		{
+			fmt::throw_exception("av_frame_alloc() failed" HERE);
+		}
+
+		return frame;
+	}
+
+	void free_frame(AVFrame* frame)
+	{
+		av_frame_unref(frame);
+
+		if (!frame_pool.try_push(frame))
+		{
+			av_frame_free(&frame);
+		}
+	}
+
 	void non_task()
 	{
 		while (true)
@@ -226,28 +260,19 @@ public:
 
 				struct AVPacketHolder : AVPacket
 				{
-					AVPacketHolder(u32 size)
+					AVPacketHolder()
 					{
 						av_init_packet(this);
-
-						if (size)
-						{
-							data = (u8*)av_calloc(1, size + AV_INPUT_BUFFER_PADDING_SIZE);
-							this->size = size + AV_INPUT_BUFFER_PADDING_SIZE;
-						}
-						else
-						{
-							data = NULL;
-							size = 0;
-						}
+						data = NULL;
+						size = 0;
 					}
 
 					~AVPacketHolder()
 					{
-						av_free(data);
+						av_packet_unref(this);
 					}
 
-				} au(0);
+				} au;
 
 				if (just_started && just_finished)
 				{
@@ -301,37 +326,35 @@ public:
 						break;
 					}
 
+					// Release the previous packet (av_read_frame() returns reference-counted packets)
+					av_packet_unref(&au);
+
 					last_frame = av_read_frame(fmt, &au) < 0;
 					if (last_frame)
 					{
 						//break;
-						av_free(au.data);
-						au.data = NULL;
-						au.size = 0;
+						av_packet_unref(&au);
 					}
 
 					struct AdecFrameHolder : AdecFrame
 					{
-						AdecFrameHolder()
+						AudioDecoder& adec;
+
+						AdecFrameHolder(AudioDecoder& adec)
+							: adec(adec)
 						{
-							data = av_frame_alloc();
+							data = adec.alloc_frame();
 						}
 
 						~AdecFrameHolder()
 						{
 							if (data)
 							{
-								av_frame_unref(data);
-								av_frame_free(&data);
+								adec.free_frame(data);
 							}
 						}
 
-					} frame;
-
-					if (!frame.data)
-					{
-						fmt::throw_exception("av_frame_alloc() failed" HERE);
-					}
+					} frame(*this);
 
 					int got_frame = 0;
 
@@ -402,6 +425,7 @@ public:
 		}
 
 		is_finished = true;
+		finished.notify();
 	}
 };
 
@@ -600,10 +624,14 @@ s32 cellAdecClose(u32 handle)
 	adec->is_closed = true;
 	adec->job.try_push(AdecTask(adecClose));
 
-	while (!adec->is_finished)
+	// Wake up the decoder if it waits for queue space
+	adec->job.notify_all();
+	adec->frames.notify_all();
+
+	adec->finished.wait([&]()
 	{
-		thread_ctrl::wait_for(1000); // hack
-	}
+		return adec->is_finished;
+	});
 
 	idm::remove<ppu_thread>(handle);
 	return CELL_OK;
@@ -718,11 +746,12 @@ s32 cellAdecGetPcm(u32 handle, vm::ptr<float> outBuffer)
 		return CELL_ADEC_ERROR_EMPTY;
 	}
 
-	std::unique_ptr<AVFrame, void(*)(AVFrame*)> frame(af.data, [](AVFrame* frame)
+	auto recycle = [&](AVFrame* frame)
 	{
-		av_frame_unref(frame);
-		av_frame_free(&frame);
-	});
+		adec->free_frame(frame);
+	};
+
+	std::unique_ptr<AVFrame, decltype(recycle)> frame(af.data, recycle);
 
 	if (outBuffer)
 	{
@@ -7,6 +7,7 @@
 #include "cellAudio.h"
 #include <atomic>
 #include <cmath>
+#include <chrono>
 
 LOG_CHANNEL(cellAudio);
 
@@ -46,9 +47,9 @@ cell_audio_config::cell_audio_config()
 	{
 		cellAudio.error("Audio backend %s does not support buffering, this option will be ignored.", backend->GetName());
 	}
-	if (raw_time_stretching_enabled && !time_stretching_enabled)
+	if (time_stretching_resampled)
 	{
-		cellAudio.error("Audio backend %s does not support time stretching, this option will be ignored.", backend->GetName());
+		cellAudio.notice("Audio backend %s does not support time stretching, audio will be resampled.", backend->GetName());
 	}
 }
 
@@ -76,6 +77,11 @@ audio_ringbuffer::audio_ringbuffer(cell_audio_config& _cfg)
 		m_dump.reset(new AudioDumper(cfg.audio_channels));
 	}
 
+	if (cfg.time_stretching_resampled)
+	{
+		m_resampler.reset(new AudioResampler(cfg.audio_channels));
+	}
+
 	// Initialize backend
 	{
 		std::string str;
@@ -106,7 +112,12 @@ audio_ringbuffer::~audio_ringbuffer()
 
 f32 audio_ringbuffer::set_frequency_ratio(f32 new_ratio)
 {
-	if (!has_capability(AudioBackend::SET_FREQUENCY_RATIO))
+	if (m_resampler)
+	{
+		// Limit the amount of resampled data
+		frequency_ratio = std::clamp(new_ratio, 0.5f, 1.0f);
+	}
+	else if (!has_capability(AudioBackend::SET_FREQUENCY_RATIO))
 	{
 		ASSERT(new_ratio == 1.0f);
 		frequency_ratio = 1.0f;
@@ -135,11 +146,20 @@ void audio_ringbuffer::enqueue(const float* in_buffer)
 	// Dump audio if enabled
 	if (m_dump)
 	{
-		m_dump->WriteData(buf, cfg.audio_buffer_size);
+		m_dump->WriteData(buf, cfg.audio_buffer_size, g_cfg.audio.convert_to_u16.get());
+	}
+
+	u32 frames = AUDIO_BUFFER_SAMPLES;
+
+	if (m_resampler)
+	{
+		// Always resample to keep the stream continuous when the ratio changes
+		frames = m_resampler->process(buf, frames, frequency_ratio, g_cfg.audio.convert_to_u16.get());
+		buf = m_resampler->data();
 	}
 
 	// Enqueue audio
-	bool success = backend->AddData(buf, AUDIO_BUFFER_SAMPLES * cfg.audio_channels);
+	bool success = backend->AddData(buf, frames * cfg.audio_channels);
 	if (!success)
 	{
 		cellAudio.error("Could not enqueue buffer onto audio backend. Attempting to recover...");
@@ -207,6 +227,11 @@ void audio_ringbuffer::flush()
 
 	backend->Flush();
 
+	if (m_resampler)
+	{
+		m_resampler->reset();
+	}
+
 	if (frequency_ratio != 1.0f)
 	{
 		set_frequency_ratio(1.0f);
@@ -248,6 +273,12 @@ u64 audio_ringbuffer::update()
 		{
 			// Backend supports querying for the remaining playtime, so just ask it
 			enqueued_samples = backend->GetNumEnqueuedSamples();
+
+			if (m_resampler)
+			{
+				// Convert resampled frames back to source frames
+				enqueued_samples = static_cast<u64>(enqueued_samples * frequency_ratio);
+			}
 		}
 		else
 		{
@@ -484,6 +515,10 @@ void cell_audio_thread::operator()()
 	u32 untouched_expected = 0;
 	u32 in_progress_expected = 0;
 
+	// Mixing cost statistics
+	u64 mix_count = 0;
+	u64 mix_time = 0;
+
 	// Main cellAudio loop
 	while (thread_ctrl::state() != thread_state::aborting && !Emu.IsStopped())
 	{
@@ -709,6 +744,8 @@ void cell_audio_thread::operator()()
 		}
 
 		// Mix
+		const auto mix_start = std::chrono::steady_clock::now();
+
 		float *buf = ringbuffer->get_current_buffer();
 		if (cfg.audio_channels == 2)
 		{
@@ -723,6 +760,9 @@ void cell_audio_thread::operator()()
 			fmt::throw_exception("Unsupported number of audio channels: %u", cfg.audio_channels);
 		}
 
+		mix_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mix_start).count();
+		mix_count++;
+
 		// Enqueue
 		ringbuffer->enqueue();
 
@@ -730,10 +770,126 @@ void cell_audio_thread::operator()()
 		advance(timestamp);
 	}
 
+	if (mix_count)
+	{
+		cellAudio.notice("Mixed %llu periods, %llu ns per period on average", mix_count, mix_time / mix_count);
+	}
+
 	// Destroy ringbuffer
 	ringbuffer.reset();
 }
 
+namespace
+{
+	// Load 4 big-endian floats
+	inline __m128 load_be_ps(const void* ptr)
+	{
+		const __m128i v = _mm_loadu_si128(static_cast<const __m128i*>(ptr));
+#ifdef __SSSE3__
+		return _mm_castsi128_ps(_mm_shuffle_epi8(v, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)));
+#else
+		const __m128i s = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		return _mm_castsi128_ps(_mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xb1), 0xb1));
+#endif
+	}
+
+#ifdef __AVX2__
+	// Load 8 big-endian floats
+	inline __m256 load_be_ps256(const void* ptr)
+	{
+		const __m256i mask = _mm256_set_epi8(
+			12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+			12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+		return _mm256_castsi256_ps(_mm256_shuffle_epi8(_mm256_loadu_si256(static_cast<const __m256i*>(ptr)), mask));
+	}
+#endif
+
+	// Calculate port volume for every frame of the period, returns true if the volume change is complete
+	// part of cellAudioSetPortLevel functionality: port volume changes are spread over 13ms
+	bool get_port_levels(const audio_port& port, const audio_port::level_set_t& param, float* levels)
+	{
+		const float start = port.level;
+
+		if (param.inc == 0.0f)
+		{
+			std::fill_n(levels, AUDIO_BUFFER_SAMPLES, start);
+			return false;
+		}
+
+		for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i++)
+		{
+			const float level = start + param.inc * (i + 1);
+			levels[i] = param.inc < 0.0f ? std::max(level, param.value) : std::min(level, param.value);
+		}
+
+		return levels[AUDIO_BUFFER_SAMPLES - 1] == param.value;
+	}
+
+	// Mix 2-channel port into stereo output
+	void mix_2ch_to_2ch(float* out, const be_t<float>* in, const float* levels)
+	{
+		for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i += 4, in += 8, out += 8)
+		{
+#ifdef __AVX2__
+			const __m256 lv = _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(levels + i)), _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+			_mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_mul_ps(load_be_ps256(in), lv)));
+#else
+			const __m128 lv = _mm_loadu_ps(levels + i);
+			_mm_storeu_ps(out + 0, _mm_add_ps(_mm_loadu_ps(out + 0), _mm_mul_ps(load_be_ps(in + 0), _mm_unpacklo_ps(lv, lv))));
+			_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(load_be_ps(in + 4), _mm_unpackhi_ps(lv, lv))));
+#endif
+		}
+	}
+
+	// Mix 2-channel port into front channels of 8-channel output
+	void mix_2ch_to_8ch(float* out, const be_t<float>* in, const float* levels)
+	{
+		for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i += 2, in += 4, out += 16)
+		{
+			// Only two levels are used (don't read past the end of the array)
+			const __m128 lv = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(levels + i)));
+			const __m128 v = _mm_mul_ps(load_be_ps(in), _mm_unpacklo_ps(lv, lv));
+			_mm_storel_pi(reinterpret_cast<__m64*>(out + 0), _mm_add_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(out + 0)), v));
+			_mm_storel_pi(reinterpret_cast<__m64*>(out + 8), _mm_add_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(out + 8)), _mm_movehl_ps(v, v)));
+		}
+	}
+
+	// Mix 8-channel port into 8-channel output
+	void mix_8ch_to_8ch(float* out, const be_t<float>* in, const float* levels)
+	{
+		for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i++, in += 8, out += 8)
+		{
+#ifdef __AVX2__
+			const __m256 lv = _mm256_broadcast_ss(levels + i);
+			_mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_mul_ps(load_be_ps256(in), lv)));
+#else
+			const __m128 lv = _mm_set1_ps(levels[i]);
+			_mm_storeu_ps(out + 0, _mm_add_ps(_mm_loadu_ps(out + 0), _mm_mul_ps(load_be_ps(in + 0), lv)));
+			_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(load_be_ps(in + 4), lv)));
+#endif
+		}
+	}
+
+	// Downmix 8-channel port into stereo output
+	void mix_8ch_to_2ch(float* out, const be_t<float>* in, const float* levels)
+	{
+		const __m128 mid_scale = _mm_set1_ps(0.708f);
+
+		for (u32 i = 0; i < AUDIO_BUFFER_SAMPLES; i++, in += 8, out += 2)
+		{
+			// a = {left, right, center, low_freq}, b = {rear_left, rear_right, side_left, side_right}
+			const __m128 a = load_be_ps(in + 0);
+			const __m128 b = load_be_ps(in + 4);
+			const __m128 c = _mm_movehl_ps(a, a);
+			const __m128 mid = _mm_mul_ps(_mm_add_ps(c, _mm_shuffle_ps(c, c, 0xb1)), mid_scale);
+			const __m128 sum = _mm_add_ps(_mm_add_ps(a, _mm_add_ps(b, _mm_movehl_ps(b, b))), mid);
+			const __m128 v = _mm_mul_ps(sum, _mm_set1_ps(levels[i]));
+			_mm_storel_pi(reinterpret_cast<__m64*>(out), _mm_add_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(out)), v));
+		}
+	}
+}
+
 template <bool DownmixToStereo>
 void cell_audio_thread::mix(float *out_buffer, s32 offset)
 {
@@ -742,160 +898,57 @@ void cell_audio_thread::mix(float *out_buffer, s32 offset)
 	constexpr u32 channels = DownmixToStereo ? 2 : 8;
 	constexpr u32 out_buffer_sz = channels * AUDIO_BUFFER_SAMPLES;
 
-	bool first_mix = true;
+	// Ports are accumulated into the silent buffer
+	std::memset(out_buffer, 0, out_buffer_sz * sizeof(float));
 
 	// mixing
 	for (auto& port : ports)
 	{
 		if (port.state != audio_port_state::started) continue;
 
-		auto buf = port.get_vm_ptr(offset);
-		static const float k = 1.0f;
-		float& m = port.level;
+		const auto buf = port.get_vm_ptr(offset);
 
-		// part of cellAudioSetPortLevel functionality
-		// spread port volume changes over 13ms
-		auto step_volume = [](audio_port& port)
-		{
-			const auto param = port.level_set.load();
-
-			if (param.inc != 0.0f)
-			{
-				port.level += param.inc;
-				const bool dec = param.inc < 0.0f;
-
-				if ((!dec && param.value - port.level <= 0.0f) || (dec && param.value - port.level >= 0.0f))
-				{
-					port.level = param.value;
-					port.level_set.compare_and_swap(param, { param.value, 0.0f });
-				}
-			}
-		};
+		// Volume ramp is computed once per period
+		alignas(16) float levels[AUDIO_BUFFER_SAMPLES];
+		const auto param = port.level_set.load();
+		const bool level_reached = get_port_levels(port, param, levels);
 
 		if (port.num_channels == 2)
 		{
-			if (first_mix)
+			if constexpr (DownmixToStereo)
 			{
-				for (u32 out = 0, in = 0; out < out_buffer_sz; out += channels, in += 2)
-				{
-					step_volume(port);
-
-					const float left  = buf[in + 0] * m;
-					const float right = buf[in + 1] * m;
-
-					out_buffer[out + 0] = left;
-					out_buffer[out + 1] = right;
-
-					if constexpr (!DownmixToStereo)
-					{
-						out_buffer[out + 2] = 0.0f;
-						out_buffer[out + 3] = 0.0f;
-						out_buffer[out + 4] = 0.0f;
-						out_buffer[out + 5] = 0.0f;
-						out_buffer[out + 6] = 0.0f;
-						out_buffer[out + 7] = 0.0f;
-					}
-				}
-				first_mix = false;
+				mix_2ch_to_2ch(out_buffer, buf, levels);
 			}
 			else
 			{
-				for (u32 out = 0, in = 0; out < out_buffer_sz; out += channels, in += 2)
-				{
-					step_volume(port);
-
-					const float left  = buf[in + 0] * m;
-					const float right = buf[in + 1] * m;
-
-					out_buffer[out + 0] += left;
-					out_buffer[out + 1] += right;
-				}
+				mix_2ch_to_8ch(out_buffer, buf, levels);
 			}
 		}
 		else if (port.num_channels == 8)
 		{
-			if (first_mix)
+			if constexpr (DownmixToStereo)
 			{
-				for (u32 out = 0, in = 0; out < out_buffer_sz; out += channels, in += 8)
-				{
-					step_volume(port);
-
-					const float left       = buf[in + 0] * m;
-					const float right      = buf[in + 1] * m;
-					const float center     = buf[in + 2] * m;
-					const float low_freq   = buf[in + 3] * m;
-					const float rear_left  = buf[in + 4] * m;
-					const float rear_right = buf[in + 5] * m;
-					const float side_left  = buf[in + 6] * m;
-					const float side_right = buf[in + 7] * m;
-
-					if constexpr (DownmixToStereo)
-					{
-						const float mid = (center + low_freq) * 0.708f;
-						out_buffer[out + 0] = (left + rear_left + side_left + mid) * k;
-						out_buffer[out + 1] = (right + rear_right + side_right + mid) * k;
-					}
-					else
-					{
-						out_buffer[out + 0] = left;
-						out_buffer[out + 1] = right;
-						out_buffer[out + 2] = center;
-						out_buffer[out + 3] = low_freq;
-						out_buffer[out + 4] = rear_left;
-						out_buffer[out + 5] = rear_right;
-						out_buffer[out + 6] = side_left;
-						out_buffer[out + 7] = side_right;
-					}
-				}
-				first_mix = false;
+				mix_8ch_to_2ch(out_buffer, buf, levels);
 			}
 			else
 			{
-				for (u32 out = 0, in = 0; out < out_buffer_sz; out += channels, in += 8)
-				{
-					step_volume(port);
-
-					const float left       = buf[in + 0] * m;
-					const float right      = buf[in + 1] * m;
-					const float center     = buf[in + 2] * m;
-					const float low_freq   = buf[in + 3] * m;
-					const float rear_left  = buf[in + 4] * m;
-					const float rear_right = buf[in + 5] * m;
-					const float side_left  = buf[in + 6] * m;
-					const float side_right = buf[in + 7] * m;
-
-					if constexpr (DownmixToStereo)
-					{
-						const float mid = (center + low_freq) * 0.708f;
-						out_buffer[out + 0] += (left + rear_left + side_left + mid) * k;
-						out_buffer[out + 1] += (right + rear_right + side_right + mid) * k;
-					}
-					else
-					{
-						out_buffer[out + 0] += left;
-						out_buffer[out + 1] += right;
-						out_buffer[out + 2] += center;
-						out_buffer[out + 3] += low_freq;
-						out_buffer[out + 4] += rear_left;
-						out_buffer[out + 5] += rear_right;
-						out_buffer[out + 6] += side_left;
-						out_buffer[out + 7] += side_right;
-					}
-				}
+				mix_8ch_to_8ch(out_buffer, buf, levels);
 			}
 		}
 		else
 		{
 			fmt::throw_exception("Unknown channel count (port=%u, channel=%d)" HERE, port.number, port.num_channels);
 		}
-	}
 
-	// Nothing was mixed, memset out_buffer to 0
-	if (first_mix)
-	{
-		std::memset(out_buffer, 0, out_buffer_sz * sizeof(float));
+		port.level = levels[AUDIO_BUFFER_SAMPLES - 1];
+
+		if (level_reached)
+		{
+			port.level_set.compare_and_swap(param, { param.value, 0.0f });
+		}
 	}
-	else if (g_cfg.audio.convert_to_u16)
+
+	if (g_cfg.audio.convert_to_u16)
 	{
 		// convert the data from float to u16 with clipping:
 		// 2x MULPS
@@ -5,6 +5,7 @@
 #include "Emu/Memory/vm.h"
 #include "Emu/Audio/AudioBackend.h"
 #include "Emu/Audio/AudioDumper.h"
+#include "Emu/Audio/AudioResampler.h"
 
 // Error codes
 enum CellAudioError : u32
@@ -210,8 +211,9 @@ public:
 private:
 	const bool raw_time_stretching_enabled = buffering_enabled && g_cfg.audio.enable_time_stretching && (g_cfg.audio.time_stretching_threshold > 0);
 public:
-	// We need to be able to set a dynamic frequency ratio to be able to do time stretching
-	const bool time_stretching_enabled = raw_time_stretching_enabled && backend->has_capability(AudioBackend::SET_FREQUENCY_RATIO);
+	// Backends which can't set a dynamic frequency ratio are fed with resampled data
+	const bool time_stretching_enabled = raw_time_stretching_enabled;
+	const bool time_stretching_resampled = time_stretching_enabled && !backend->has_capability(AudioBackend::SET_FREQUENCY_RATIO);
 
 	const f32 time_stretching_threshold = g_cfg.audio.time_stretching_threshold / 100.0f; // we only apply time stretching below this buffer fill rate (adjusted for average period)
 	const f32 time_stretching_step = 0.1f; // will only reduce/increase the frequency ratio in steps of at least this value
@@ -234,6 +236,9 @@ private:
 
 	std::unique_ptr<AudioDumper> m_dump;
 
+	// Time stretching for backends without SET_FREQUENCY_RATIO
+	std::unique_ptr<AudioResampler> m_resampler;
+
 	std::unique_ptr<float[]> buffer[MAX_AUDIO_BUFFERS];
 	const float silence_buffer[AUDIO_MAX_CHANNELS_COUNT * AUDIO_BUFFER_SAMPLES] = { 0 };
 
@@ -193,6 +193,9 @@ public:
 	atomic_t<bool> is_running;
 	atomic_t<bool> is_working;
 
+	// Notified on new tasks, released AUs and demuxer state changes
+	squeue_event event;
+
 	Demuxer(u32 addr, u32 size, vm::ptr<CellDmuxCbMsg> func, u32 arg)
 		: ppu_thread({}, "", 0)
 		, is_finished(false)
@@ -206,6 +209,24 @@ public:
 	{
 	}
 
+	// Queue a task and wake up the demuxer thread if it waits for free space
+	bool push_job(const DemuxerTask& task)
+	{
+		const bool res = job.push(task, &is_closed);
+		event.notify();
+		return res;
+	}
+
+	// Wait for free space in the elementary stream (returns early on new tasks)
+	template <typename F>
+	void wait_space(F&& has_space)
+	{
+		event.wait([&]()
+		{
+			return has_space() || !job.is_empty() || is_closed || Emu.IsStopped();
+		});
+	}
+
 	void non_task()
 	{
 		DemuxerTask task;
@@ -246,6 +267,7 @@ public:
 					lv2_obj::sleep(*this);
 
 					is_working = false;
+					event.notify();
 
 					stream = {};
 
@@ -352,7 +374,7 @@ public:
 						if (es.raw_data.size() > 1024 * 1024)
 						{
 							stream = backup;
-							std::this_thread::sleep_for(1ms); // hack
+							wait_space([&]() { return es.raw_data.size() <= 1024 * 1024; });
 							continue;
 						}
 
@@ -449,7 +471,7 @@ public:
 						if (es.isfull(old_size))
 						{
 							stream = backup;
-							std::this_thread::sleep_for(1ms); // hack
+							wait_space([&]() { return !es.isfull(old_size); });
 							continue;
 						}
 
@@ -545,6 +567,7 @@ public:
 					stream = {};
 
 					is_working = false;
+					event.notify();
 				}
 
 				break;
@@ -615,12 +638,10 @@ public:
 				if (old_size && (es.fidMajor & -0x10) == 0xe0)
 				{
 					// TODO (it's only for AVC, some ATX data may be lost)
-					while (es.isfull(old_size))
+					event.wait([&]()
 					{
-						if (Emu.IsStopped() || is_closed) break;
-
-						std::this_thread::sleep_for(1ms); // hack
-					}
+						return !es.isfull(old_size) || is_closed || Emu.IsStopped();
+					});
 
 					es.push_au(old_size, es.last_dts, es.last_pts, stream.userdata, false, 0);
 
@@ -665,6 +686,7 @@ public:
 		}
 
 		is_finished = true;
+		event.notify();
 	}
 };
 
@@ -860,29 +882,34 @@ void ElementaryStream::push(DemuxerStream& stream, u32 size)
 
 bool ElementaryStream::release()
 {
-	std::lock_guard lock(m_mutex);
-	if (released >= put_count)
 	{
-		cellDmux.error("es::release() error: buffer is empty");
-		Emu.Pause();
-		return false;
-	}
-	if (released >= got_count)
-	{
-		cellDmux.error("es::release() error: buffer has not been seen yet");
-		Emu.Pause();
-		return false;
-	}
+		std::lock_guard lock(m_mutex);
+		if (released >= put_count)
+		{
+			cellDmux.error("es::release() error: buffer is empty");
+			Emu.Pause();
+			return false;
+		}
+		if (released >= got_count)
+		{
+			cellDmux.error("es::release() error: buffer has not been seen yet");
+			Emu.Pause();
+			return false;
+		}
 
-	u32 addr = 0;
-	if (!entries.pop(addr, &dmux->is_closed) || !addr)
-	{
-		cellDmux.error("es::release() error: entries.Pop() failed");
-		Emu.Pause();
-		return false;
+		u32 addr = 0;
+		if (!entries.pop(addr, &dmux->is_closed) || !addr)
+		{
+			cellDmux.error("es::release() error: entries.Pop() failed");
+			Emu.Pause();
+			return false;
+		}
+
+		released++;
 	}
 
-	released++;
+	// Wake up the demuxer if it waits for free space
+	dmux->event.notify();
 	return true;
 }
 
@@ -1036,16 +1063,18 @@ s32 cellDmuxClose(u32 handle)
 
 	dmux->is_closed = true;
 	dmux->job.try_push(DemuxerTask(dmuxClose));
+	dmux->job.notify_all();
+	dmux->event.notify();
 
-	while (!dmux->is_finished)
+	dmux->event.wait([&]()
 	{
-		if (Emu.IsStopped())
-		{
-			cellDmux.warning("cellDmuxClose(%d) aborted", handle);
-			return CELL_OK;
-		}
+		return dmux->is_finished || Emu.IsStopped();
+	});
 
-		std::this_thread::sleep_for(1ms); // hack
+	if (!dmux->is_finished)
+	{
+		cellDmux.warning("cellDmuxClose(%d) aborted", handle);
+		return CELL_OK;
 	}
 
 	idm::remove<ppu_thread>(handle);
@@ -1076,7 +1105,7 @@ s32 cellDmuxSetStream(u32 handle, u32 streamAddress, u32 streamSize, b8 disconti
 	info.discontinuity = discontinuity;
 	info.userdata = userData;
 
-	dmux->job.push(task, &dmux->is_closed);
+	dmux->push_job(task);
 	return CELL_OK;
 }
 
@@ -1091,7 +1120,7 @@ s32 cellDmuxResetStream(u32 handle)
 		return CELL_DMUX_ERROR_ARG;
 	}
 
-	dmux->job.push(DemuxerTask(dmuxResetStream), &dmux->is_closed);
+	dmux->push_job(DemuxerTask(dmuxResetStream));
 	return CELL_OK;
 }
 
@@ -1113,16 +1142,17 @@ s32 cellDmuxResetStreamAndWaitDone(u32 handle)
 
 	dmux->is_working = true;
 
-	dmux->job.push(DemuxerTask(dmuxResetStreamAndWaitDone), &dmux->is_closed);
+	dmux->push_job(DemuxerTask(dmuxResetStreamAndWaitDone));
 
-	while (dmux->is_running && dmux->is_working && !dmux->is_closed) // TODO: ensure that it is safe
+	// TODO: ensure that it is safe
+	dmux->event.wait([&]()
 	{
-		if (Emu.IsStopped())
-		{
-			cellDmux.warning("cellDmuxResetStreamAndWaitDone(%d) aborted", handle);
-			return CELL_OK;
-		}
-		std::this_thread::sleep_for(1ms); // hack
+		return !(dmux->is_running && dmux->is_working && !dmux->is_closed) || Emu.IsStopped();
+	});
+
+	if (Emu.IsStopped())
+	{
+		cellDmux.warning("cellDmuxResetStreamAndWaitDone(%d) aborted", handle);
 	}
 
 	return CELL_OK;
@@ -1182,7 +1212,7 @@ s32 cellDmuxEnableEs(u32 handle, vm::cptr<CellCodecEsFilterId> esFilterId, vm::c
 	task.es.es = es->id;
 	task.es.es_ptr = es.get();
 
-	dmux->job.push(task, &dmux->is_closed);
+	dmux->push_job(task);
 	return CELL_OK;
 }
 
@@ -1201,7 +1231,7 @@ s32 cellDmuxDisableEs(u32 esHandle)
 	task.es.es = esHandle;
 	task.es.es_ptr = es.get();
 
-	es->dmux->job.push(task, &es->dmux->is_closed);
+	es->dmux->push_job(task);
 	return CELL_OK;
 }
 
@@ -1220,7 +1250,7 @@ s32 cellDmuxResetEs(u32 esHandle)
 	task.es.es = esHandle;
 	task.es.es_ptr = es.get();
 
-	es->dmux->job.push(task, &es->dmux->is_closed);
+	es->dmux->push_job(task);
 	return CELL_OK;
 }
 
@@ -1349,7 +1379,7 @@ s32 cellDmuxFlushEs(u32 esHandle)
 	task.es.es = esHandle;
 	task.es.es_ptr = es.get();
 
-	es->dmux->job.push(task, &es->dmux->is_closed);
+	es->dmux->push_job(task);
 	return CELL_OK;
 }
 
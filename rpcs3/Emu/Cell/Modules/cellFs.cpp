@@ -5,11 +5,14 @@
 
 #include "Emu/Cell/lv2/sys_fs.h"
 #include "Emu/Cell/lv2/sys_sync.h"
+#include "Emu/Cell/lv2/sys_ppu_thread.h"
+#include "sysPrxForUser.h"
 #include "cellFs.h"
 
 #include "Utilities/StrUtil.h"
 
 #include <mutex>
+#include <deque>
 
 LOG_CHANNEL(cellFs);
 
@@ -649,9 +652,185 @@ error_code cellFsSetDiscReadRetrySetting()
 	return CELL_OK;
 }
 
+struct fs_st_stream;
+
+// Host read-ahead worker of a stream
+struct fs_st_reader
+{
+	fs_st_stream& st;
+
+	explicit fs_st_reader(fs_st_stream& st)
+		: st(st)
+	{
+	}
+
+	void operator()();
+};
+
+// Stream reading context (cellFsStRead*)
+struct fs_st_stream
+{
+	const u32 fd;
+	const std::shared_ptr<lv2_file> file;
+	const u64 ringbuf_size;
+	const u64 block_size;
+	const u64 transfer_rate;
+	const s32 copy;
+
+	// Ring buffer in guest memory
+	const u32 buf;
+
+	shared_mutex mutex;
+
+	// Signaled when data arrives or the state changes (for waiting PPU threads)
+	cond_variable cond;
+
+	// Streaming state (protected by mutex)
+	bool active = false;
+	bool eof = false;
+	bool finished = false;
+	u32 gen = 0; // Incremented on every start/stop to discard outdated reads
+	u64 pos = 0; // Next file offset to read
+	u64 end = 0; // End file offset
+	u64 head = 0; // Total bytes written into the ring buffer
+	u64 tail = 0; // Total bytes consumed
+
+	// Pending cellFsStReadWaitCallback request
+	vm::ptr<void(s32 xfd, u64 xsize)> cb_func{};
+	u64 cb_size = 0;
+	u64 cb_tid = 0;
+
+	// Statistics since cellFsStReadStart
+	u64 stat_bytes = 0;
+	u64 stat_time = 0;
+
+	std::unique_ptr<named_thread<fs_st_reader>> reader;
+
+	fs_st_stream(u32 fd, std::shared_ptr<lv2_file> file, const CellFsRingBuffer& ringbuf, u32 buf)
+		: fd(fd)
+		, file(std::move(file))
+		, ringbuf_size(ringbuf.ringbuf_size)
+		, block_size(ringbuf.block_size)
+		, transfer_rate(ringbuf.transfer_rate)
+		, copy(ringbuf.copy)
+		, buf(buf)
+	{
+	}
+
+	u64 get_available() const
+	{
+		return head - tail;
+	}
+
+	void notify()
+	{
+		if (reader)
+		{
+			thread_ctrl::notify(*reader);
+		}
+
+		cond.notify_all();
+	}
+
+	void report()
+	{
+		if (stat_bytes)
+		{
+			cellFs.notice("cellFsStRead: fd=%d, %llu bytes read in %.3f ms (%.3f MB/s)", fd, stat_bytes, stat_time / 1000.,
+				stat_time ? stat_bytes / 1.048576 / stat_time : 0.);
+		}
+
+		stat_bytes = 0;
+		stat_time = 0;
+	}
+};
+
+void fs_st_reader::operator()()
+{
+	while (thread_ctrl::state() != thread_state::aborting)
+	{
+		std::unique_lock lock(st.mutex);
+
+		// Read block by block while there is free space (the last block may be partial)
+		const u64 size = std::min(st.block_size, st.end - std::min(st.pos, st.end));
+
+		if (!st.active || st.eof || !size || st.ringbuf_size - st.get_available() < size)
+		{
+			lock.unlock();
+			thread_ctrl::wait();
+			continue;
+		}
+
+		const u32 addr = st.buf + static_cast<u32>(st.head % st.ringbuf_size);
+		const u64 offset = st.pos;
+		const u32 gen = st.gen;
+
+		lock.unlock();
+
+		const u64 start = get_system_time();
+
+		u64 nread;
+		{
+			// Positional read, the file position is not affected
+			const auto file_lock = st.file->lock_positional_io();
+			nread = st.file->op_read(vm::ptr<void>::make(addr), size, offset);
+		}
+
+		lock.lock();
+
+		if (gen != st.gen)
+		{
+			// Stopped or restarted during the read
+			continue;
+		}
+
+		st.head += nread;
+		st.pos += nread;
+		st.stat_bytes += nread;
+		st.stat_time += get_system_time() - start;
+
+		if (nread < size || st.pos >= st.end)
+		{
+			st.eof = true;
+		}
+
+		lock.unlock();
+		st.cond.notify_all();
+	}
+}
+
+struct fs_st_manager
+{
+	shared_mutex mutex;
+
+	std::unordered_map<u32, std::shared_ptr<fs_st_stream>> streams;
+
+	std::shared_ptr<fs_st_stream> get(u32 fd)
+	{
+		reader_lock lock(mutex);
+
+		if (const auto found = streams.find(fd); found != streams.end())
+		{
+			return found->second;
+		}
+
+		return nullptr;
+	}
+};
+
+static std::shared_ptr<fs_st_stream> fs_st_get(u32 fd)
+{
+	if (const auto m = fxm::get<fs_st_manager>())
+	{
+		return m->get(fd);
+	}
+
+	return nullptr;
+}
+
 s32 cellFsStReadInit(u32 fd, vm::cptr<CellFsRingBuffer> ringbuf)
 {
-	cellFs.todo("cellFsStReadInit(fd=%d, ringbuf=*0x%x)", fd, ringbuf);
+	cellFs.warning("cellFsStReadInit(fd=%d, ringbuf=*0x%x)", fd, ringbuf);
 
 	if (ringbuf->copy & ~CELL_FS_ST_COPYLESS)
 	{
@@ -663,7 +842,12 @@ s32 cellFsStReadInit(u32 fd, vm::cptr<CellFsRingBuffer> ringbuf)
 		return CELL_EINVAL;
 	}
 
-	if (ringbuf->ringbuf_size % ringbuf->block_size) // check if a multiple of block_size
+	if (!ringbuf->block_size || ringbuf->ringbuf_size % ringbuf->block_size) // check if a multiple of block_size
+	{
+		return CELL_EINVAL;
+	}
+
+	if (!ringbuf->ringbuf_size || ringbuf->ringbuf_size > 0x10000000)
 	{
 		return CELL_EINVAL;
 	}
@@ -680,271 +864,696 @@ s32 cellFsStReadInit(u32 fd, vm::cptr<CellFsRingBuffer> ringbuf)
 		return CELL_EPERM;
 	}
 
-	// TODO
+	const auto m = fxm::get_always<fs_st_manager>();
+
+	std::lock_guard lock(m->mutex);
+
+	if (m->streams.count(fd))
+	{
+		return CELL_EBUSY;
+	}
+
+	const u32 buf = vm::alloc(static_cast<u32>(ringbuf->ringbuf_size), vm::main);
+
+	if (!buf)
+	{
+		return CELL_ENOMEM;
+	}
+
+	const auto st = std::make_shared<fs_st_stream>(fd, file, *ringbuf, buf);
+	st->reader = std::make_unique<named_thread<fs_st_reader>>(fmt::format("FS Stream Reader (fd=%d)", fd), *st);
+	m->streams.emplace(fd, st);
 
 	return CELL_OK;
 }
 
-s32 cellFsStReadFinish(u32 fd)
+s32 cellFsStReadFinish(ppu_thread& ppu, u32 fd)
 {
-	cellFs.todo("cellFsStReadFinish(fd=%d)", fd);
+	cellFs.warning("cellFsStReadFinish(fd=%d)", fd);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto m = fxm::get<fs_st_manager>();
 
-	if (!file)
+	std::shared_ptr<fs_st_stream> st;
+
+	if (m)
+	{
+		std::lock_guard lock(m->mutex);
+
+		if (const auto found = m->streams.find(fd); found != m->streams.end())
+		{
+			st = std::move(found->second);
+			m->streams.erase(found);
+		}
+	}
+
+	if (!st)
 	{
 		return CELL_EBADF; // ???
 	}
 
-	// TODO
+	u64 cb_tid;
+	{
+		std::lock_guard lock(st->mutex);
+		st->active = false;
+		st->finished = true;
+		st->gen++;
+		st->report();
+		cb_tid = st->cb_tid;
+	}
+
+	st->notify();
+
+	if (cb_tid)
+	{
+		// Stop the callback thread
+		ppu_execute<&sys_interrupt_thread_disestablish>(ppu, static_cast<u32>(cb_tid));
+	}
+
+	// Join the reader thread before freeing the ring buffer
+	st->reader.reset();
+	vm::dealloc_verbose_nothrow(st->buf, vm::main);
 
 	return CELL_OK;
 }
 
 s32 cellFsStReadGetRingBuf(u32 fd, vm::ptr<CellFsRingBuffer> ringbuf)
 {
-	cellFs.todo("cellFsStReadGetRingBuf(fd=%d, ringbuf=*0x%x)", fd, ringbuf);
+	cellFs.trace("cellFsStReadGetRingBuf(fd=%d, ringbuf=*0x%x)", fd, ringbuf);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	ringbuf->ringbuf_size = st->ringbuf_size;
+	ringbuf->block_size = st->block_size;
+	ringbuf->transfer_rate = st->transfer_rate;
+	ringbuf->copy = st->copy;
 
 	return CELL_OK;
 }
 
 s32 cellFsStReadGetStatus(u32 fd, vm::ptr<u64> status)
 {
-	cellFs.todo("cellFsStReadGetRingBuf(fd=%d, status=*0x%x)", fd, status);
+	cellFs.trace("cellFsStReadGetStatus(fd=%d, status=*0x%x)", fd, status);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		if (!idm::check<lv2_fs_object, lv2_file>(fd))
+		{
+			return CELL_EBADF;
+		}
+
+		*status = CELL_FS_ST_NOT_INITIALIZED | CELL_FS_ST_STOP;
+		return CELL_OK;
 	}
 
-	// TODO
+	reader_lock lock(st->mutex);
+
+	*status = CELL_FS_ST_INITIALIZED | (st->active && !st->eof ? CELL_FS_ST_PROGRESS : CELL_FS_ST_STOP);
 
 	return CELL_OK;
 }
 
 s32 cellFsStReadGetRegid(u32 fd, vm::ptr<u64> regid)
 {
-	cellFs.todo("cellFsStReadGetRingBuf(fd=%d, regid=*0x%x)", fd, regid);
+	cellFs.trace("cellFsStReadGetRegid(fd=%d, regid=*0x%x)", fd, regid);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	// Bandwidth reservation is not emulated
+	*regid = 0;
 
 	return CELL_OK;
 }
 
 s32 cellFsStReadStart(u32 fd, u64 offset, u64 size)
 {
-	cellFs.todo("cellFsStReadStart(fd=%d, offset=0x%llx, size=0x%llx)", fd, offset, size);
+	cellFs.warning("cellFsStReadStart(fd=%d, offset=0x%llx, size=0x%llx)", fd, offset, size);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	const u64 file_size = st->file->file.size();
+
+	if (offset >= file_size)
+	{
+		return CELL_EINVAL;
+	}
+
+	{
+		std::lock_guard lock(st->mutex);
+
+		st->report();
+		st->active = true;
+		st->eof = false;
+		st->gen++;
+		st->pos = offset;
+		st->end = size >= file_size - offset ? file_size : offset + size;
+		st->head = 0;
+		st->tail = 0;
+	}
+
+	st->notify();
 
 	return CELL_OK;
 }
 
 s32 cellFsStReadStop(u32 fd)
 {
-	cellFs.todo("cellFsStReadStop(fd=%d)", fd);
+	cellFs.warning("cellFsStReadStop(fd=%d)", fd);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	{
+		std::lock_guard lock(st->mutex);
+
+		st->active = false;
+		st->gen++;
+		st->report();
+	}
+
+	st->notify();
 
 	return CELL_OK;
 }
 
 s32 cellFsStRead(u32 fd, vm::ptr<u8> buf, u64 size, vm::ptr<u64> rsize)
 {
-	cellFs.todo("cellFsStRead(fd=%d, buf=*0x%x, size=0x%llx, rsize=*0x%x)", fd, buf, size, rsize);
+	cellFs.trace("cellFsStRead(fd=%d, buf=*0x%x, size=0x%llx, rsize=*0x%x)", fd, buf, size, rsize);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	if (!buf || !rsize)
+	{
+		return CELL_EFAULT;
+	}
 
+	u64 result = 0;
+	{
+		std::lock_guard lock(st->mutex);
+
+		result = std::min(size, st->get_available());
+
+		// Copy available data, the ring buffer may wrap once
+		for (u64 done = 0; done < result;)
+		{
+			const u64 off = (st->tail + done) % st->ringbuf_size;
+			const u64 chunk = std::min(result - done, st->ringbuf_size - off);
+			std::memcpy(buf.get_ptr() + done, vm::base(st->buf + static_cast<u32>(off)), chunk);
+			done += chunk;
+		}
+
+		st->tail += result;
+	}
+
+	st->notify();
+
+	*rsize = result;
 	return CELL_OK;
 }
 
 s32 cellFsStReadGetCurrentAddr(u32 fd, vm::ptr<u32> addr, vm::ptr<u64> size)
 {
-	cellFs.todo("cellFsStReadGetCurrentAddr(fd=%d, addr=*0x%x, size=*0x%x)", fd, addr, size);
+	cellFs.trace("cellFsStReadGetCurrentAddr(fd=%d, addr=*0x%x, size=*0x%x)", fd, addr, size);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	if (!addr || !size)
+	{
+		return CELL_EFAULT;
+	}
+
+	reader_lock lock(st->mutex);
+
+	// Return contiguous available data
+	const u64 off = st->tail % st->ringbuf_size;
+
+	*addr = st->buf + static_cast<u32>(off);
+	*size = std::min(st->get_available(), st->ringbuf_size - off);
 
 	return CELL_OK;
 }
 
 s32 cellFsStReadPutCurrentAddr(u32 fd, vm::ptr<u8> addr, u64 size)
 {
-	cellFs.todo("cellFsStReadPutCurrentAddr(fd=%d, addr=*0x%x, size=0x%llx)", fd, addr, size);
+	cellFs.trace("cellFsStReadPutCurrentAddr(fd=%d, addr=*0x%x, size=0x%llx)", fd, addr, size);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	{
+		std::lock_guard lock(st->mutex);
+
+		if (addr.addr() != st->buf + st->tail % st->ringbuf_size || size > st->get_available())
+		{
+			return CELL_EINVAL;
+		}
+
+		st->tail += size;
+	}
+
+	st->notify();
 
 	return CELL_OK;
 }
 
-s32 cellFsStReadWait(u32 fd, u64 size)
+s32 cellFsStReadWait(ppu_thread& ppu, u32 fd, u64 size)
 {
-	cellFs.todo("cellFsStReadWait(fd=%d, size=0x%llx)", fd, size);
+	cellFs.trace("cellFsStReadWait(fd=%d, size=0x%llx)", fd, size);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	const auto st = fs_st_get(fd);
 
-	if (!file)
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	if (size > st->ringbuf_size)
+	{
+		return CELL_EINVAL;
+	}
+
+	std::unique_lock lock(st->mutex);
+
+	if (st->get_available() >= size || st->eof || !st->active)
+	{
+		return CELL_OK;
+	}
+
+	lock.unlock();
+
+	lv2_obj::sleep(ppu);
+
+	lock.lock();
+
+	while (st->get_available() < size && !st->eof && st->active && !st->finished)
+	{
+		if (ppu.is_stopped())
+		{
+			return 0;
+		}
+
+		st->cond.wait(st->mutex, 1000);
+	}
 
 	return CELL_OK;
 }
 
-s32 cellFsStReadWaitCallback(u32 fd, u64 size, vm::ptr<void(s32 xfd, u64 xsize)> func)
+static void fsStReadCallbackEntry(ppu_thread& ppu, u32 fd)
 {
-	cellFs.todo("cellFsStReadWaitCallback(fd=%d, size=0x%llx, func=*0x%x)", fd, size, func);
+	const auto st = fs_st_get(fd);
 
-	const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+	while (st && !ppu.is_stopped())
+	{
+		std::unique_lock lock(st->mutex);
 
-	if (!file)
+		if (st->finished)
+		{
+			break;
+		}
+
+		const u64 available = st->get_available();
+
+		if (!st->cb_func || (available < st->cb_size && !st->eof && st->active))
+		{
+			lock.unlock();
+			lv2_obj::sleep(ppu);
+			lock.lock();
+
+			if (!st->finished && (!st->cb_func || (st->get_available() < st->cb_size && !st->eof && st->active)))
+			{
+				st->cond.wait(st->mutex, 1000);
+			}
+
+			continue;
+		}
+
+		const auto func = std::exchange(st->cb_func, vm::null);
+
+		lock.unlock();
+
+		func(ppu, fd, available);
+	}
+
+	ppu.state += cpu_flag::exit;
+}
+
+s32 cellFsStReadWaitCallback(ppu_thread& ppu, u32 fd, u64 size, vm::ptr<void(s32 xfd, u64 xsize)> func)
+{
+	cellFs.trace("cellFsStReadWaitCallback(fd=%d, size=0x%llx, func=*0x%x)", fd, size, func);
+
+	const auto st = fs_st_get(fd);
+
+	if (!st)
 	{
-		return CELL_EBADF;
+		return idm::check<lv2_fs_object, lv2_file>(fd) ? CELL_ENXIO : CELL_EBADF;
 	}
 
-	// TODO
+	if (!func || size > st->ringbuf_size)
+	{
+		return CELL_EINVAL;
+	}
+
+	bool create = false;
+	{
+		std::lock_guard lock(st->mutex);
+
+		if (st->cb_func)
+		{
+			return CELL_EBUSY;
+		}
+
+		st->cb_func = func;
+		st->cb_size = size;
+		create = !st->cb_tid;
+	}
+
+	if (create)
+	{
+		// Run callback thread
+		vm::var<u64> _tid;
+		vm::var<char[]> _name = vm::make_str("HLE FS Stream Callback");
+		ppu_execute<&sys_ppu_thread_create>(ppu, +_tid, 0x10000, fd, 1001, 0x4000, SYS_PPU_THREAD_CREATE_INTERRUPT, +_name);
+
+		const auto thrd = idm::get<named_thread<ppu_thread>>(static_cast<u32>(*_tid));
+
+		{
+			std::lock_guard lock(st->mutex);
+			st->cb_tid = *_tid;
+		}
+
+		thrd->cmd_list
+		({
+			{ ppu_cmd::set_args, 1 }, u64{fd},
+			{ ppu_cmd::hle_call, FIND_FUNC(fsStReadCallbackEntry) },
+		});
+
+		thrd->state -= cpu_flag::stop;
+		thread_ctrl::notify(*thrd);
+	}
+
+	st->notify();
 
 	return CELL_OK;
 }
 
 using fs_aio_cb_t = vm::ptr<void(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)>;
 
-// temporarily
-struct lv2_fs_mount_point
+// AIO request (type: 1 = read, 2 = write)
+struct fs_aio_request
 {
-	std::mutex mutex;
+	u32 type;
+	s32 xid;
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
 };
 
-struct fs_aio_thread : ppu_thread
+// AIO completion delivered to the callback thread
+struct fs_aio_result
 {
-	using ppu_thread::ppu_thread;
+	s32 xid;
+	s32 error;
+	u64 size;
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
+};
+
+struct fs_aio_manager;
+
+// Host I/O worker, several requests are executed concurrently and complete out of order
+struct fs_aio_worker
+{
+	fs_aio_manager& m;
+
+	explicit fs_aio_worker(fs_aio_manager& m)
+		: m(m)
+	{
+	}
+
+	void operator()();
+};
+
+struct fs_aio_manager
+{
+	// Serializes cellFsAioInit and cellFsAioFinish
+	std::mutex init_mutex;
 
-	void non_task()
+	shared_mutex mutex;
+
+	// Pending requests (protected by mutex)
+	std::deque<fs_aio_request> queue;
+
+	// Completed requests
+	lf_queue<fs_aio_result> done;
+
+	// Number of submitted requests whose callback has not returned yet
+	atomic_t<u32> pending{0};
+
+	// Thread waiting in cellFsAioFinish, notified when pending drops to 0 (protected by mutex)
+	cpu_thread* waiter = nullptr;
+
+	// Number of cellFsAioInit calls not finished (protected by mutex)
+	u32 users = 0;
+
+	// Guest thread running the callbacks
+	u64 ppu_tid = 0;
+
+	// Host workers (protected by mutex)
+	std::vector<std::unique_ptr<named_thread<fs_aio_worker>>> workers;
+
+	void notify()
 	{
-		while (cmd64 cmd = cmd_wait())
+		for (auto& w : workers)
 		{
-			const u32 type = cmd.arg1<u32>();
-			const s32 xid = cmd.arg2<s32>();
-			const cmd64 cmd2 = cmd_get(1);
-			const auto aio = cmd2.arg1<vm::ptr<CellFsAio>>();
-			const auto func = cmd2.arg2<fs_aio_cb_t>();
-			cmd_pop(1);
+			thread_ctrl::notify(*w);
+		}
+	}
 
-			s32 error = CELL_OK;
-			u64 result = 0;
+	static fs_aio_result execute(const fs_aio_request& req)
+	{
+		fs_aio_result res{req.xid, CELL_OK, 0, req.aio, req.func};
 
-			const auto file = idm::get<lv2_fs_object, lv2_file>(aio->fd);
+		const auto file = idm::get<lv2_fs_object, lv2_file>(req.aio->fd);
 
-			if (!file || (type == 1 && file->flags & CELL_FS_O_WRONLY) || (type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+		if (!file || (req.type == 1 && file->flags & CELL_FS_O_WRONLY) || (req.type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+		{
+			res.error = CELL_EBADF;
+			return res;
+		}
+
+		// Positional I/O, requests on the same file are only serialized if the handle doesn't support it
+		const auto file_lock = file->lock_positional_io();
+
+		res.size = req.type == 2
+			? file->op_write(req.aio->buf, req.aio->size, req.aio->offset)
+			: file->op_read(req.aio->buf, req.aio->size, req.aio->offset);
+
+		return res;
+	}
+};
+
+void fs_aio_worker::operator()()
+{
+	while (thread_ctrl::state() != thread_state::aborting)
+	{
+		fs_aio_request req;
+		{
+			std::lock_guard lock(m.mutex);
+
+			if (m.queue.empty())
 			{
-				error = CELL_EBADF;
+				req.type = 0;
 			}
 			else
 			{
-				std::lock_guard lock(file->mp->mutex);
+				req = m.queue.front();
+				m.queue.pop_front();
+			}
+		}
 
-				const auto old_pos = file->file.pos(); file->file.seek(aio->offset);
+		if (!req.type)
+		{
+			thread_ctrl::wait();
+			continue;
+		}
 
-				result = type == 2
-					? file->op_write(aio->buf, aio->size)
-					: file->op_read(aio->buf, aio->size);
+		m.done.push(fs_aio_manager::execute(req));
+	}
+}
 
-				file->file.seek(old_pos);
-			}
+static void fsAioCallbackEntry(ppu_thread& ppu, u32)
+{
+	const auto m = fxm::get<fs_aio_manager>();
 
-			func(*this, aio, error, xid, result);
-			lv2_obj::sleep(*this);
+	for (auto res = m->done.pop_all(); !ppu.is_stopped(); res ? res.pop_front() : res = m->done.pop_all())
+	{
+		if (!res)
+		{
+			m->done.wait(1000);
+			continue;
 		}
+
+		res->func(ppu, res->aio, res->error, res->xid, res->size);
+
+		if (!--m->pending)
+		{
+			reader_lock lock(m->mutex);
+
+			if (m->waiter)
+			{
+				m->waiter->notify();
+			}
+		}
+
+		lv2_obj::sleep(ppu);
 	}
-};
 
-struct fs_aio_manager
-{
-	std::shared_ptr<fs_aio_thread> thread;
-};
+	ppu.state += cpu_flag::exit;
+}
 
-s32 cellFsAioInit(vm::cptr<char> mount_point)
+s32 cellFsAioInit(ppu_thread& ppu, vm::cptr<char> mount_point)
 {
 	cellFs.warning("cellFsAioInit(mount_point=%s)", mount_point);
 
-	// TODO: create AIO thread (if not exists) for specified mount point
-	const auto m = fxm::make<fs_aio_manager>();
+	// TODO: use separate queues for each mount point
+	const auto m = fxm::get_always<fs_aio_manager>();
+
+	std::lock_guard init_lock(m->init_mutex);
+
+	{
+		std::lock_guard lock(m->mutex);
+
+		if (m->users++)
+		{
+			return CELL_OK;
+		}
+
+		const u32 count = std::clamp<u32>(std::thread::hardware_concurrency() / 2, 2, 4);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			m->workers.emplace_back(std::make_unique<named_thread<fs_aio_worker>>(fmt::format("FS AIO Worker %u", i), *m));
+		}
+	}
+
+	// Run callback thread
+	vm::var<u64> _tid;
+	vm::var<char[]> _name = vm::make_str("HLE FS AIO Callback");
+	ppu_execute<&sys_ppu_thread_create>(ppu, +_tid, 0x10000, 0, 1001, 0x4000, SYS_PPU_THREAD_CREATE_INTERRUPT, +_name);
 
-	fmt::throw_exception("cellFsAio disabled, use LLE.");
+	m->ppu_tid = *_tid;
+
+	const auto thrd = idm::get<named_thread<ppu_thread>>(static_cast<u32>(m->ppu_tid));
+
+	thrd->cmd_list
+	({
+		{ ppu_cmd::set_args, 1 }, u64{0},
+		{ ppu_cmd::hle_call, FIND_FUNC(fsAioCallbackEntry) },
+	});
+
+	thrd->state -= cpu_flag::stop;
+	thread_ctrl::notify(*thrd);
 
 	return CELL_OK;
 }
 
-s32 cellFsAioFinish(vm::cptr<char> mount_point)
+s32 cellFsAioFinish(ppu_thread& ppu, vm::cptr<char> mount_point)
 {
 	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
 
-	// TODO: delete existing AIO thread for specified mount point
+	const auto m = fxm::get<fs_aio_manager>();
+
+	if (!m)
+	{
+		return CELL_EINVAL;
+	}
+
+	std::lock_guard init_lock(m->init_mutex);
+
+	{
+		std::lock_guard lock(m->mutex);
+
+		if (!m->users)
+		{
+			return CELL_EINVAL;
+		}
+
+		if (--m->users)
+		{
+			return CELL_OK;
+		}
+	}
+
+	// No new requests are accepted, let the queued ones complete and their callbacks return
+	lv2_obj::sleep(ppu);
+
+	std::lock_guard{m->mutex}, m->waiter = &ppu;
+
+	while (m->pending)
+	{
+		if (ppu.is_stopped())
+		{
+			std::lock_guard{m->mutex}, m->waiter = nullptr;
+			return 0;
+		}
+
+		thread_ctrl::wait();
+	}
+
+	decltype(m->workers) workers;
+	{
+		std::lock_guard lock(m->mutex);
+		m->waiter = nullptr;
+		workers.swap(m->workers);
+	}
+
+	// Join the workers (not under the lock they take)
+	workers.clear();
+
+	ppu_execute<&sys_interrupt_thread_disestablish>(ppu, static_cast<u32>(m->ppu_tid));
+	m->ppu_tid = 0;
 
 	return CELL_OK;
 }
 
 atomic_t<s32> g_fs_aio_id;
 
-s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+static s32 fs_aio_submit(u32 type, vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 {
-	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
-
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+	// TODO: detect mount point and send AIO request to the queue of this mount point
 
 	const auto m = fxm::get<fs_aio_manager>();
 
@@ -953,46 +1562,60 @@ s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 		return CELL_ENXIO;
 	}
 
+	std::lock_guard lock(m->mutex);
+
+	if (!m->users)
+	{
+		return CELL_ENXIO;
+	}
+
 	const s32 xid = (*id = ++g_fs_aio_id);
 
-	m->thread->cmd_list
-	({
-		{ 1, xid },
-		{ aio, func },
-	});
+	m->pending++;
+	m->queue.emplace_back(fs_aio_request{type, xid, aio, func});
+	m->notify();
 
 	return CELL_OK;
 }
 
+s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+
+	return fs_aio_submit(1, aio, id, func);
+}
+
 s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 {
 	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
 
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+	return fs_aio_submit(2, aio, id, func);
+}
+
+s32 cellFsAioCancel(s32 id)
+{
+	cellFs.warning("cellFsAioCancel(id=%d)", id);
 
 	const auto m = fxm::get<fs_aio_manager>();
 
 	if (!m)
 	{
-		return CELL_ENXIO;
+		return CELL_EINVAL;
 	}
 
-	const s32 xid = (*id = ++g_fs_aio_id);
+	std::lock_guard lock(m->mutex);
 
-	m->thread->cmd_list
-	({
-		{ 2, xid },
-		{ aio, func },
-	});
-
-	return CELL_OK;
-}
-
-s32 cellFsAioCancel(s32 id)
-{
-	cellFs.todo("cellFsAioCancel(id=%d) -> CELL_EINVAL", id);
-
-	// TODO: cancelled requests return CELL_ECANCELED through their own callbacks
+	// Only requests not yet started can be cancelled
+	for (auto it = m->queue.begin(); it != m->queue.end(); it++)
+	{
+		if (it->xid == id)
+		{
+			// Cancelled requests return CELL_ECANCELED through their own callbacks
+			m->done.push(fs_aio_result{id, static_cast<s32>(CELL_ECANCELED), 0, it->aio, it->func});
+			m->queue.erase(it);
+			return CELL_OK;
+		}
+	}
 
 	return CELL_EINVAL;
 }
@@ -1086,6 +1709,8 @@ DECLARE(ppu_module_manager::cellFs)("sys_fs", []()
 	REG_FUNC(sys_fs, cellFsStReadStop);
 	REG_FUNC(sys_fs, cellFsStReadWait);
 	REG_FUNC(sys_fs, cellFsStReadWaitCallback);
+	REG_FUNC(sys_fs, fsStReadCallbackEntry).flag(MFF_HIDDEN);
+	REG_FUNC(sys_fs, fsAioCallbackEntry).flag(MFF_HIDDEN);
 	REG_FUNC(sys_fs, cellFsSymbolicLink);
 	REG_FUNC(sys_fs, cellFsTruncate);
 	REG_FUNC(sys_fs, cellFsTruncate2);
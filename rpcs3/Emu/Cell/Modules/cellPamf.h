@@ -406,6 +406,44 @@ extern const std::function<bool()> SQUEUE_NEVER_EXIT;
 
 bool squeue_test_exit();
 
+// Condition for the media HLE threads: waiters re-check their predicate on every notify()
+// The timeout is only used to observe conditions which are never notified (emulation stop)
+class squeue_event
+{
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	atomic_t<u32> m_waiters{0};
+
+public:
+	template <typename F>
+	void wait(F&& pred)
+	{
+		std::unique_lock lock(m_mutex);
+
+		m_waiters++;
+
+		while (!pred())
+		{
+			m_cond.wait_for(lock, std::chrono::milliseconds(10));
+		}
+
+		m_waiters--;
+	}
+
+	void notify()
+	{
+		if (m_waiters)
+		{
+			// Serialize with the predicate check of a waiter about to sleep
+			{
+				std::lock_guard lock(m_mutex);
+			}
+
+			m_cond.notify_all();
+		}
+	}
+};
+
 // TODO: eliminate this boolshit
 template<typename T, u32 sq_size = 256>
 class squeue_t
@@ -426,10 +464,8 @@ class squeue_t
 
 	atomic_t<squeue_sync_var_t> m_sync;
 
-	mutable std::mutex m_rcv_mutex;
-	mutable std::mutex m_wcv_mutex;
-	mutable std::condition_variable m_rcv;
-	mutable std::condition_variable m_wcv;
+	squeue_event m_rcv;
+	squeue_event m_wcv;
 
 	T m_data[sq_size];
 
@@ -456,35 +492,54 @@ public:
 		return m_sync.load().count == sq_size;
 	}
 
+	bool is_empty() const
+	{
+		return m_sync.load().count == 0;
+	}
+
+	// Wake up all waiters to re-check their exit condition
+	void notify_all()
+	{
+		m_rcv.notify();
+		m_wcv.notify();
+	}
+
 	bool push(const T& data, const std::function<bool()>& test_exit)
 	{
 		u32 pos = 0;
+		u32 res = SQSVR_OK;
 
-		while (u32 res = m_sync.atomic_op([&pos](squeue_sync_var_t& sync) -> u32
+		const auto try_lock = [&]()
 		{
-			verify(HERE), sync.count <= sq_size, sync.position < sq_size;
-
-			if (sync.push_lock)
-			{
-				return SQSVR_LOCKED;
-			}
-			if (sync.count == sq_size)
+			res = m_sync.atomic_op([&pos](squeue_sync_var_t& sync) -> u32
 			{
-				return SQSVR_FAILED;
-			}
+				verify(HERE), sync.count <= sq_size, sync.position < sq_size;
+
+				if (sync.push_lock)
+				{
+					return SQSVR_LOCKED;
+				}
+				if (sync.count == sq_size)
+				{
+					return SQSVR_FAILED;
+				}
+
+				sync.push_lock = 1;
+				pos = sync.position + sync.count;
+				return SQSVR_OK;
+			});
+
+			return res == SQSVR_OK || (res == SQSVR_FAILED && (test_exit() || squeue_test_exit()));
+		};
 
-			sync.push_lock = 1;
-			pos = sync.position + sync.count;
-			return SQSVR_OK;
-		}))
+		if (!try_lock())
 		{
-			if (res == SQSVR_FAILED && (test_exit() || squeue_test_exit()))
-			{
-				return false;
-			}
+			m_wcv.wait(try_lock);
+		}
 
-			std::unique_lock<std::mutex> wcv_lock(m_wcv_mutex);
-			m_wcv.wait_for(wcv_lock, std::chrono::milliseconds(1));
+		if (res != SQSVR_OK)
+		{
+			return false;
 		}
 
 		m_data[pos >= sq_size ? pos - sq_size : pos] = data;
@@ -496,8 +551,8 @@ public:
 			sync.count++;
 		});
 
-		m_rcv.notify_one();
-		m_wcv.notify_one();
+		m_rcv.notify();
+		m_wcv.notify();
 		return true;
 	}
 
@@ -519,32 +574,39 @@ public:
 	bool pop(T& data, const std::function<bool()>& test_exit)
 	{
 		u32 pos = 0;
+		u32 res = SQSVR_OK;
 
-		while (u32 res = m_sync.atomic_op([&pos](squeue_sync_var_t& sync) -> u32
+		const auto try_lock = [&]()
 		{
-			verify(HERE), sync.count <= sq_size, sync.position < sq_size;
-
-			if (!sync.count)
-			{
-				return SQSVR_FAILED;
-			}
-			if (sync.pop_lock)
+			res = m_sync.atomic_op([&pos](squeue_sync_var_t& sync) -> u32
 			{
-				return SQSVR_LOCKED;
-			}
+				verify(HERE), sync.count <= sq_size, sync.position < sq_size;
+
+				if (!sync.count)
+				{
+					return SQSVR_FAILED;
+				}
+				if (sync.pop_lock)
+				{
+					return SQSVR_LOCKED;
+				}
 
-			sync.pop_lock = 1;
-			pos = sync.position;
-			return SQSVR_OK;
-		}))
+				sync.pop_lock = 1;
+				pos = sync.position;
+				return SQSVR_OK;
+			});
+
+			return res == SQSVR_OK || (res == SQSVR_FAILED && (test_exit() || squeue_test_exit()));
+		};
+
+		if (!try_lock())
 		{
-			if (res == SQSVR_FAILED && (test_exit() || squeue_test_exit()))
-			{
-				return false;
-			}
+			m_rcv.wait(try_lock);
+		}
 
-			std::unique_lock<std::mutex> rcv_lock(m_rcv_mutex);
-			m_rcv.wait_for(rcv_lock, std::chrono::milliseconds(1));
+		if (res != SQSVR_OK)
+		{
+			return false;
 		}
 
 		data = m_data[pos];
@@ -561,8 +623,8 @@ public:
 			}
 		});
 
-		m_rcv.notify_one();
-		m_wcv.notify_one();
+		m_rcv.notify();
+		m_wcv.notify();
 		return true;
 	}
 
@@ -585,32 +647,39 @@ public:
 	{
 		verify(HERE), start_pos < sq_size;
 		u32 pos = 0;
+		u32 res = SQSVR_OK;
 
-		while (u32 res = m_sync.atomic_op([&pos, start_pos](squeue_sync_var_t& sync) -> u32
+		const auto try_lock = [&]()
 		{
-			verify(HERE), sync.count <= sq_size, sync.position < sq_size;
-
-			if (sync.count <= start_pos)
-			{
-				return SQSVR_FAILED;
-			}
-			if (sync.pop_lock)
+			res = m_sync.atomic_op([&pos, start_pos](squeue_sync_var_t& sync) -> u32
 			{
-				return SQSVR_LOCKED;
-			}
+				verify(HERE), sync.count <= sq_size, sync.position < sq_size;
+
+				if (sync.count <= start_pos)
+				{
+					return SQSVR_FAILED;
+				}
+				if (sync.pop_lock)
+				{
+					return SQSVR_LOCKED;
+				}
+
+				sync.pop_lock = 1;
+				pos = sync.position + start_pos;
+				return SQSVR_OK;
+			});
 
-			sync.pop_lock = 1;
-			pos = sync.position + start_pos;
-			return SQSVR_OK;
-		}))
+			return res == SQSVR_OK || (res == SQSVR_FAILED && (test_exit() || squeue_test_exit()));
+		};
+
+		if (!try_lock())
 		{
-			if (res == SQSVR_FAILED && (test_exit() || squeue_test_exit()))
-			{
-				return false;
-			}
+			m_rcv.wait(try_lock);
+		}
 
-			std::unique_lock<std::mutex> rcv_lock(m_rcv_mutex);
-			m_rcv.wait_for(rcv_lock, std::chrono::milliseconds(1));
+		if (res != SQSVR_OK)
+		{
+			return false;
 		}
 
 		data = m_data[pos >= sq_size ? pos - sq_size : pos];
@@ -621,7 +690,7 @@ public:
 			sync.pop_lock = 0;
 		});
 
-		m_rcv.notify_one();
+		m_rcv.notify();
 		return true;
 	}
 
@@ -667,25 +736,24 @@ public:
 	{
 		u32 pos, count;
 
-		while (m_sync.atomic_op([&pos, &count](squeue_sync_var_t& sync) -> u32
+		m_rcv.wait([&]()
 		{
-			verify(HERE), sync.count <= sq_size, sync.position < sq_size;
-
-			if (sync.pop_lock || sync.push_lock)
+			return !m_sync.atomic_op([&pos, &count](squeue_sync_var_t& sync) -> u32
 			{
-				return SQSVR_LOCKED;
-			}
+				verify(HERE), sync.count <= sq_size, sync.position < sq_size;
 
-			pos = sync.position;
-			count = sync.count;
-			sync.pop_lock = 1;
-			sync.push_lock = 1;
-			return SQSVR_OK;
-		}))
-		{
-			std::unique_lock<std::mutex> rcv_lock(m_rcv_mutex);
-			m_rcv.wait_for(rcv_lock, std::chrono::milliseconds(1));
-		}
+				if (sync.pop_lock || sync.push_lock)
+				{
+					return SQSVR_LOCKED;
+				}
+
+				pos = sync.position;
+				count = sync.count;
+				sync.pop_lock = 1;
+				sync.push_lock = 1;
+				return SQSVR_OK;
+			});
+		});
 
 		proc(squeue_data_t(m_data, pos, count));
 
@@ -696,32 +764,31 @@ public:
 			sync.push_lock = 0;
 		});
 
-		m_wcv.notify_one();
-		m_rcv.notify_one();
+		m_wcv.notify();
+		m_rcv.notify();
 	}
 
 	void clear()
 	{
-		while (m_sync.atomic_op([](squeue_sync_var_t& sync) -> u32
+		m_rcv.wait([&]()
 		{
-			verify(HERE), sync.count <= sq_size, sync.position < sq_size;
-
-			if (sync.pop_lock || sync.push_lock)
+			return !m_sync.atomic_op([](squeue_sync_var_t& sync) -> u32
 			{
-				return SQSVR_LOCKED;
-			}
+				verify(HERE), sync.count <= sq_size, sync.position < sq_size;
 
-			sync.pop_lock = 1;
-			sync.push_lock = 1;
-			return SQSVR_OK;
-		}))
-		{
-			std::unique_lock<std::mutex> rcv_lock(m_rcv_mutex);
-			m_rcv.wait_for(rcv_lock, std::chrono::milliseconds(1));
-		}
+				if (sync.pop_lock || sync.push_lock)
+				{
+					return SQSVR_LOCKED;
+				}
+
+				sync.pop_lock = 1;
+				sync.push_lock = 1;
+				return SQSVR_OK;
+			});
+		});
 
 		m_sync.exchange({});
-		m_wcv.notify_one();
-		m_rcv.notify_one();
+		m_wcv.notify();
+		m_rcv.notify();
 	}
 };
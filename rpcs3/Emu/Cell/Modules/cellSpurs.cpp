@@ -2,6 +2,7 @@
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
 #include "Emu/Cell/PPUModule.h"
+#include "Emu/Memory/vm_reservation.h"
 #include "Utilities/asm.h"
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/lv2/sys_lwmutex.h"
@@ -49,6 +50,10 @@ namespace _spurs
 	// Check whether libprof is loaded
 	bool is_libprof_loaded();
 
+	// Modify the workload state line (the first 128 bytes) as a guest atomic would, wake idle SPU kernels if func returns true
+	template <typename F>
+	void update_wkl_state(vm::ptr<CellSpurs> spurs, F&& func);
+
 	// Create an LV2 event queue and attach it to the SPURS instance
 	s32 create_lv2_eq(ppu_thread& ppu, vm::ptr<CellSpurs> spurs, vm::ptr<u32> queueId, vm::ptr<u8> port, s32 size, const sys_event_queue_attribute_t& name);
 
@@ -369,6 +374,23 @@ bool _spurs::is_libprof_loaded()
 	return false;
 }
 
+template <typename F>
+void _spurs::update_wkl_state(vm::ptr<CellSpurs> spurs, F&& func)
+{
+	// SPU kernels select workloads and wait for work with reservations on this line
+	const u32 addr = spurs.addr();
+
+	auto& res = vm::reservation_lock(addr, 128);
+	const u64 old_time = res.load() & -128;
+	const bool wake = func();
+	res.release(old_time + 128);
+
+	if (wake)
+	{
+		vm::reservation_notifier(addr, 128).notify_all();
+	}
+}
+
 //----------------------------------------------------------------------------
 // SPURS core functions
 //----------------------------------------------------------------------------
@@ -1623,10 +1645,15 @@ s32 cellSpursSetMaxContention(vm::ptr<CellSpurs> spurs, u32 wid, u32 maxContenti
 		maxContention = CELL_SPURS_MAX_SPU;
 	}
 
-	spurs->wklMaxContention[wid % CELL_SPURS_MAX_WORKLOAD].atomic_op([spurs, wid, maxContention](u8& value)
+	_spurs::update_wkl_state(spurs, [&]
 	{
-		value &= wid < CELL_SPURS_MAX_WORKLOAD ? 0xF0 : 0x0F;
-		value |= wid < CELL_SPURS_MAX_WORKLOAD ? maxContention : maxContention << 4;
+		spurs->wklMaxContention[wid % CELL_SPURS_MAX_WORKLOAD].atomic_op([spurs, wid, maxContention](u8& value)
+		{
+			value &= wid < CELL_SPURS_MAX_WORKLOAD ? 0xF0 : 0x0F;
+			value |= wid < CELL_SPURS_MAX_WORKLOAD ? maxContention : maxContention << 4;
+		});
+
+		return true;
 	});
 
 	return CELL_OK;
@@ -1683,7 +1710,13 @@ s32 cellSpursSetPriorities(vm::ptr<CellSpurs> spurs, u32 wid, vm::cptr<u8> prior
 	*((be_t<u64>*)wklInfo->priority) = prio;
 
 	spurs->sysSrvMsgUpdateWorkload = 0xff;
-	spurs->sysSrvMessage = 0xff;
+
+	_spurs::update_wkl_state(spurs, [&]
+	{
+		spurs->sysSrvMessage = 0xff;
+		return true;
+	});
+
 	return CELL_OK;
 }
 
@@ -1830,7 +1863,12 @@ void _spurs::trace_status_update(ppu_thread& ppu, vm::ptr<CellSpurs> spurs)
 
 	if (init)
 	{
-		spurs->sysSrvMessage = 0xff;
+		_spurs::update_wkl_state(spurs, [&]
+		{
+			spurs->sysSrvMessage = 0xff;
+			return true;
+		});
+
 		CHECK_SUCCESS(sys_semaphore_wait(ppu, (u32)spurs->semPrv, 0));
 	}
 }
@@ -2169,14 +2207,6 @@ s32 _spurs::add_workload(vm::ptr<CellSpurs> spurs, vm::ptr<u32> wid, vm::cptr<vo
 			spurs->wklF1[wnum].hookArg = hookArg;
 			spurs->wklEvent1[wnum] |= 2;
 		}
-
-		if ((spurs->flags1 & SF1_32_WORKLOADS) == 0)
-		{
-			spurs->wklIdleSpuCountOrReadyCount2[wnum] = 0;
-			spurs->wklMinContention[wnum] = minContention > 8 ? 8 : minContention;
-		}
-
-		spurs->wklReadyCount1[wnum] = 0;
 	}
 	else
 	{
@@ -2205,30 +2235,42 @@ s32 _spurs::add_workload(vm::ptr<CellSpurs> spurs, vm::ptr<u32> wid, vm::cptr<vo
 			spurs->wklF2[index].hookArg = hookArg;
 			spurs->wklEvent2[index] |= 2;
 		}
-
-		spurs->wklIdleSpuCountOrReadyCount2[wnum] = 0;
 	}
 
-	if (wnum <= 15)
+	_spurs::update_wkl_state(spurs, [&]
 	{
-		spurs->wklMaxContention[wnum].atomic_op([maxContention](u8& v)
+		if (wnum <= 15)
 		{
-			v &= ~0xf;
-			v |= (maxContention > 8 ? 8 : maxContention);
-		});
-		spurs->wklSignal1.fetch_and(~(0x8000 >> index)); // clear bit in wklFlag1
-	}
-	else
-	{
-		spurs->wklMaxContention[index].atomic_op([maxContention](u8& v)
+			if ((spurs->flags1 & SF1_32_WORKLOADS) == 0)
+			{
+				spurs->wklIdleSpuCountOrReadyCount2[wnum] = 0;
+				spurs->wklMinContention[wnum] = minContention > 8 ? 8 : minContention;
+			}
+
+			spurs->wklReadyCount1[wnum] = 0;
+			spurs->wklMaxContention[wnum].atomic_op([maxContention](u8& v)
+			{
+				v &= ~0xf;
+				v |= (maxContention > 8 ? 8 : maxContention);
+			});
+			spurs->wklSignal1.fetch_and(~(0x8000 >> index)); // clear bit in wklFlag1
+		}
+		else
 		{
-			v &= ~0xf0;
-			v |= (maxContention > 8 ? 8 : maxContention) << 4;
-		});
-		spurs->wklSignal2.fetch_and(~(0x8000 >> index)); // clear bit in wklFlag2
-	}
+			spurs->wklIdleSpuCountOrReadyCount2[index] = 0;
+			spurs->wklMaxContention[index].atomic_op([maxContention](u8& v)
+			{
+				v &= ~0xf0;
+				v |= (maxContention > 8 ? 8 : maxContention) << 4;
+			});
+			spurs->wklSignal2.fetch_and(~(0x8000 >> index)); // clear bit in wklFlag2
+		}
+
+		spurs->wklFlagReceiver.compare_and_swap(wnum, 0xff);
 
-	spurs->wklFlagReceiver.compare_and_swap(wnum, 0xff);
+		// The workload has no work yet
+		return false;
+	});
 
 	u32 res_wkl;
 	const auto wkl = wnum <= 15 ? &spurs->wklInfo1[wnum] : &spurs->wklInfo2[wnum & 0xf];
@@ -2263,7 +2305,13 @@ s32 _spurs::add_workload(vm::ptr<CellSpurs> spurs, vm::ptr<u32> wid, vm::cptr<vo
 	verify(HERE), (res_wkl <= 31);
 	spurs->wklState(wnum).exchange(2);
 	spurs->sysSrvMsgUpdateWorkload.exchange(0xff);
-	spurs->sysSrvMessage.exchange(0xff);
+
+	_spurs::update_wkl_state(spurs, [&]
+	{
+		spurs->sysSrvMessage.exchange(0xff);
+		return true;
+	});
+
 	return CELL_OK;
 }
 
@@ -2390,14 +2438,18 @@ s32 cellSpursSendWorkloadSignal(vm::ptr<CellSpurs> spurs, u32 wid)
 		return CELL_SPURS_POLICY_MODULE_ERROR_STAT;
 	}
 
-	if (wid >= CELL_SPURS_MAX_WORKLOAD)
+	_spurs::update_wkl_state(spurs, [&]
 	{
-		spurs->wklSignal2 |= 0x8000 >> (wid & 0x0F);
-	}
-	else
-	{
-		spurs->wklSignal1 |= 0x8000 >> wid;
-	}
+		// Wake SPUs only if the signal wasn't already pending
+		const u16 bit = 0x8000 >> (wid & 0x0F);
+
+		if (wid >= CELL_SPURS_MAX_WORKLOAD)
+		{
+			return !(spurs->wklSignal2.fetch_or(bit) & bit);
+		}
+
+		return !(spurs->wklSignal1.fetch_or(bit) & bit);
+	});
 
 	return CELL_OK;
 }
@@ -2451,14 +2503,16 @@ s32 cellSpursReadyCountStore(vm::ptr<CellSpurs> spurs, u32 wid, u32 value)
 		return CELL_SPURS_POLICY_MODULE_ERROR_STAT;
 	}
 
-	if (wid < CELL_SPURS_MAX_WORKLOAD)
-	{
-		spurs->wklReadyCount1[wid].exchange((u8)value);
-	}
-	else
+	_spurs::update_wkl_state(spurs, [&]
 	{
-		spurs->wklIdleSpuCountOrReadyCount2[wid].exchange((u8)value);
-	}
+		// Wake SPUs only if more of them are requested
+		if (wid < CELL_SPURS_MAX_WORKLOAD)
+		{
+			return spurs->wklReadyCount1[wid].exchange((u8)value) < value;
+		}
+
+		return spurs->wklIdleSpuCountOrReadyCount2[wid].exchange((u8)value) < value;
+	});
 
 	return CELL_OK;
 }
@@ -2577,48 +2631,62 @@ s32 _cellSpursWorkloadFlagReceiver(vm::ptr<CellSpurs> spurs, u32 wid, u32 is_set
 		return CELL_SPURS_POLICY_MODULE_ERROR_STAT;
 	}
 
-	std::atomic_thread_fence(std::memory_order_acq_rel);
+	s32 res = 0;
 
-	if (s32 res = spurs->wklFlag.flag.atomic_op([spurs, wid, is_set](be_t<u32>& flag) -> s32
+	_spurs::update_wkl_state(spurs, [&]
 	{
-		if (is_set)
+		res = spurs->wklFlag.flag.atomic_op([spurs, wid, is_set](be_t<u32>& flag) -> s32
 		{
-			if (spurs->wklFlagReceiver != 0xff)
+			if (is_set)
 			{
-				return CELL_SPURS_POLICY_MODULE_ERROR_BUSY;
+				if (spurs->wklFlagReceiver != 0xff)
+				{
+					return CELL_SPURS_POLICY_MODULE_ERROR_BUSY;
+				}
 			}
-		}
-		else
-		{
-			if (spurs->wklFlagReceiver != wid)
+			else
 			{
-				return CELL_SPURS_POLICY_MODULE_ERROR_PERM;
+				if (spurs->wklFlagReceiver != wid)
+				{
+					return CELL_SPURS_POLICY_MODULE_ERROR_PERM;
+				}
 			}
+			flag = -1;
+			return 0;
+		});
+
+		if (res)
+		{
+			return false;
 		}
-		flag = -1;
-		return 0;
-	}))
-	{
-		return res;
-	}
 
-	spurs->wklFlagReceiver.atomic_op([wid, is_set](u8& FR)
-	{
-		if (is_set)
+		spurs->wklFlagReceiver.atomic_op([wid, is_set](u8& FR)
 		{
-			if (FR == 0xff)
+			if (is_set)
 			{
-				FR = (u8)wid;
+				if (FR == 0xff)
+				{
+					FR = (u8)wid;
+				}
 			}
-		}
-		else
-		{
-			if (FR == wid)
+			else
 			{
-				FR = 0xff;
+				if (FR == wid)
+				{
+					FR = 0xff;
+				}
 			}
-		}
+		});
+
+		// The flag is reset, no workload becomes ready
+		return false;
 	});
+
+	if (res)
+	{
+		return res;
+	}
+
 	return CELL_OK;
 }
 
@@ -15,10 +15,13 @@ extern "C"
 
 #include "cellPamf.h"
 #include "cellVdec.h"
+#include "video_converter.h"
 
 #include <mutex>
 #include <queue>
 #include <cmath>
+#include <chrono>
+#include <thread>
 #include "Utilities/lockless.h"
 #include <variant>
 
@@ -55,12 +58,75 @@ struct vdec_frame
 	u32 frc;
 	bool PicItemRecieved = false;
 
+	// Picture converted on the decoder thread (see vdec_context::pic_format)
+	std::vector<u8> picture;
+	u32 picture_format = 0;
+
 	AVFrame* operator ->() const
 	{
 		return avf.get();
 	}
 };
 
+// Encode the output format for vdec_context::pic_format (0 is reserved)
+static u32 vdec_pic_format(u32 type, u8 alpha)
+{
+	return 1u << 31 | alpha << 8 | type;
+}
+
+static u32 vdec_picture_size(u32 type, int w, int h)
+{
+	switch (type)
+	{
+	case CELL_VDEC_PICFMT_ARGB32_ILV:
+	case CELL_VDEC_PICFMT_RGBA32_ILV: return w * h * 4;
+	case CELL_VDEC_PICFMT_UYVY422_ILV: return w * h * 2;
+	default: return w * h * 3 / 2;
+	}
+}
+
+static void vdec_convert(const AVFrame* frame, u32 type, u8 alpha, u8* out)
+{
+	const u32 w = frame->width;
+	const u32 h = frame->height;
+
+	if (frame->format != AV_PIX_FMT_YUV420P)
+	{
+		fmt::throw_exception("Unknown format (%d)" HERE, frame->format);
+	}
+
+	const video_image in{AV_PIX_FMT_YUV420P, w, h, {frame->data[0], frame->data[1], frame->data[2]}, {frame->linesize[0], frame->linesize[1], frame->linesize[2]}};
+
+	const auto conv = fxm::get_always<video_converter>();
+
+	// TODO: color matrix
+
+	switch (type)
+	{
+	case CELL_VDEC_PICFMT_ARGB32_ILV:
+	case CELL_VDEC_PICFMT_RGBA32_ILV:
+	{
+		const s32 out_f = type == CELL_VDEC_PICFMT_ARGB32_ILV ? AV_PIX_FMT_ARGB : AV_PIX_FMT_RGBA;
+		conv->yuv420_to_rgb(in, {out_f, w, h, {out}, {static_cast<s32>(w * 4)}}, alpha, SWS_POINT);
+		break;
+	}
+	case CELL_VDEC_PICFMT_UYVY422_ILV:
+	{
+		conv->convert(in, {AV_PIX_FMT_UYVY422, w, h, {out}, {static_cast<s32>(w * 2)}}, SWS_POINT);
+		break;
+	}
+	case CELL_VDEC_PICFMT_YUV420_PLANAR:
+	{
+		conv->convert(in, {AV_PIX_FMT_YUV420P, w, h, {out, out + w * h, out + w * h * 5 / 4}, {static_cast<s32>(w), static_cast<s32>(w / 2), static_cast<s32>(w / 2)}}, SWS_POINT);
+		break;
+	}
+	default:
+	{
+		fmt::throw_exception("Unknown formatType (%d)" HERE, type);
+	}
+	}
+}
+
 struct vdec_context final
 {
 	static const u32 id_base = 0xf0000000;
@@ -69,7 +135,6 @@ struct vdec_context final
 
 	AVCodec* codec{};
 	AVCodecContext* ctx{};
-	SwsContext* sws{};
 
 	shared_mutex mutex; // Used for 'out' queue (TODO)
 
@@ -92,6 +157,22 @@ struct vdec_context final
 
 	lf_queue<std::variant<vdec_start_seq_t, vdec_close_t, vdec_cmd, CellVdecFrameRate>> in_cmd;
 
+	// Last format requested by cellVdecGetPicture, the decoder thread converts new pictures to it in advance
+	atomic_t<u32> pic_format{0};
+
+	// Recycled picture buffers (protected by mutex)
+	std::vector<std::vector<u8>> pic_pool;
+
+	static constexpr u32 pic_pool_max = 8;
+
+	// Timing counters (nanoseconds)
+	u64 decode_time = 0;
+	u64 decode_count = 0;
+	u64 convert_time = 0;
+	u64 convert_count = 0;
+	atomic_t<u64> pic_hits{0};
+	atomic_t<u64> pic_misses{0};
+
 	vdec_context(s32 type, u32 profile, u32 addr, u32 size, vm::ptr<CellVdecCbMsg> func, u32 arg)
 		: type(type)
 		, mem_addr(addr)
@@ -136,6 +217,12 @@ struct vdec_context final
 			fmt::throw_exception("avcodec_alloc_context3() failed (type=0x%x)" HERE, type);
 		}
 
+		// Frame threading decodes several pictures in parallel, the additional delay is drained at the end of sequence
+		const u32 threads = g_cfg.core.vdec_threads ? g_cfg.core.vdec_threads : std::clamp<u32>(std::thread::hardware_concurrency() / 2, 1, 4);
+
+		ctx->thread_count = threads;
+		ctx->thread_type = g_cfg.core.vdec_frame_threading ? FF_THREAD_FRAME | FF_THREAD_SLICE : FF_THREAD_SLICE;
+
 		AVDictionary* opts{};
 		av_dict_set(&opts, "refcounted_frames", "1", 0);
 
@@ -147,13 +234,65 @@ struct vdec_context final
 			avcodec_free_context(&ctx);
 			fmt::throw_exception("avcodec_open2() failed (err=0x%x, opts=%d)" HERE, err, opts ? 1 : 0);
 		}
+
+		cellVdec.notice("Decoder opened (type=0x%x, threads=%u, active_thread_type=0x%x)", type, threads, ctx->active_thread_type);
 	}
 
 	~vdec_context()
 	{
+		cellVdec.notice("Decoded %llu pictures (avg %.3f ms), converted %llu in advance (avg %.3f ms), pictures ready: %llu, late: %llu",
+			decode_count, decode_count ? decode_time / 1e6 / decode_count : 0., convert_count, convert_count ? convert_time / 1e6 / convert_count : 0., pic_hits.load(), pic_misses.load());
+
 		avcodec_close(ctx);
 		avcodec_free_context(&ctx);
-		sws_freeContext(sws);
+	}
+
+	static u64 get_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Convert the picture to the predicted output format into a recycled buffer
+	void prepare_picture(vdec_frame& frame)
+	{
+		const u32 format = pic_format;
+
+		if (!format)
+		{
+			return;
+		}
+
+		const u64 start = get_ns();
+
+		{
+			std::lock_guard lock(mutex);
+
+			if (!pic_pool.empty())
+			{
+				frame.picture = std::move(pic_pool.back());
+				pic_pool.pop_back();
+			}
+		}
+
+		frame.picture.resize(vdec_picture_size(format & 0xff, frame->width, frame->height));
+		vdec_convert(frame.avf.get(), format & 0xff, format >> 8 & 0xff, frame.picture.data());
+		frame.picture_format = format;
+
+		convert_time += get_ns() - start;
+		convert_count++;
+	}
+
+	void recycle_picture(std::vector<u8>&& picture)
+	{
+		if (picture.capacity())
+		{
+			std::lock_guard lock(mutex);
+
+			if (pic_pool.size() < pic_pool_max)
+			{
+				pic_pool.emplace_back(std::move(picture));
+			}
+		}
 	}
 
 	void exec(ppu_thread& ppu, u32 vid)
@@ -223,7 +362,7 @@ struct vdec_context final
 
 				while (out_max)
 				{
-					if (cmd->mode == -1)
+					if (cmd->mode == -1 && !(ctx->active_thread_type & FF_THREAD_FRAME))
 					{
 						break;
 					}
@@ -238,8 +377,12 @@ struct vdec_context final
 
 					int got_picture = 0;
 
+					const u64 decode_start = get_ns();
+
 					int decode = avcodec_decode_video2(ctx, frame.avf.get(), &got_picture, &packet);
 
+					decode_time += get_ns() - decode_start;
+
 					if (decode < 0)
 					{
 						char av_error[AV_ERROR_MAX_STRING_SIZE];
@@ -351,6 +494,9 @@ struct vdec_context final
 
 						cellVdec.trace("Got picture (pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", frame.pts, frame->pkt_pts, frame.dts, frame->pkt_dts);
 
+						decode_count++;
+						prepare_picture(frame);
+
 						std::lock_guard{mutex}, out.push_back(std::move(frame));
 
 						cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
@@ -599,62 +745,22 @@ s32 cellVdecGetPicture(u32 handle, vm::cptr<CellVdecPicFormat> format, vm::ptr<u
 
 	if (outBuff)
 	{
-		const int w = frame->width;
-		const int h = frame->height;
+		const u32 type = format->formatType;
+		const u32 pic_format = vdec_pic_format(type, format->alpha);
 
-		AVPixelFormat out_f = AV_PIX_FMT_YUV420P;
-
-		std::unique_ptr<u8[]> alpha_plane;
-
-		switch (const u32 type = format->formatType)
-		{
-		case CELL_VDEC_PICFMT_ARGB32_ILV: out_f = AV_PIX_FMT_ARGB; alpha_plane.reset(new u8[w * h]); break;
-		case CELL_VDEC_PICFMT_RGBA32_ILV: out_f = AV_PIX_FMT_RGBA; alpha_plane.reset(new u8[w * h]); break;
-		case CELL_VDEC_PICFMT_UYVY422_ILV: out_f = AV_PIX_FMT_UYVY422; break;
-		case CELL_VDEC_PICFMT_YUV420_PLANAR: out_f = AV_PIX_FMT_YUV420P; break;
-
-		default:
-		{
-			fmt::throw_exception("Unknown formatType (%d)" HERE, type);
-		}
-		}
-
-		// TODO: color matrix
-
-		if (alpha_plane)
-		{
-			std::memset(alpha_plane.get(), format->alpha, w * h);
-		}
-
-		AVPixelFormat in_f = AV_PIX_FMT_YUV420P;
-
-		switch (frame->format)
-		{
-		case AV_PIX_FMT_YUV420P: in_f = alpha_plane ? AV_PIX_FMT_YUVA420P : AV_PIX_FMT_YUV420P; break;
-
-		default:
+		if (frame.picture_format == pic_format)
 		{
-			fmt::throw_exception("Unknown format (%d)" HERE, frame->format);
+			std::memcpy(outBuff.get_ptr(), frame.picture.data(), frame.picture.size());
+			vdec->pic_hits++;
 		}
-		}
-
-		vdec->sws = sws_getCachedContext(vdec->sws, w, h, in_f, w, h, out_f, SWS_POINT, NULL, NULL, NULL);
-
-		u8* in_data[4] = { frame->data[0], frame->data[1], frame->data[2], alpha_plane.get() };
-		int in_line[4] = { frame->linesize[0], frame->linesize[1], frame->linesize[2], w * 1 };
-		u8* out_data[4] = { outBuff.get_ptr() };
-		int out_line[4] = { w * 4 };
-
-		if (!alpha_plane)
+		else
 		{
-			out_data[1] = out_data[0] + w * h;
-			out_data[2] = out_data[0] + w * h * 5 / 4;
-			out_line[0] = w;
-			out_line[1] = w / 2;
-			out_line[2] = w / 2;
+			vdec_convert(frame.avf.get(), type, format->alpha, outBuff.get_ptr());
+			vdec->pic_misses++;
 		}
 
-		sws_scale(vdec->sws, in_data, in_line, 0, h, out_data, out_line);
+		// Predict the format of the next pictures
+		vdec->pic_format = pic_format;
 
 		//const u32 buf_size = align(av_image_get_buffer_size(vdec->ctx->pix_fmt, vdec->ctx->width, vdec->ctx->height, 1), 128);
 
@@ -667,6 +773,8 @@ s32 cellVdecGetPicture(u32 handle, vm::cptr<CellVdecPicFormat> format, vm::ptr<u
 		//}
 	}
 
+	vdec->recycle_picture(std::move(frame.picture));
+
 	return CELL_OK;
 }
 
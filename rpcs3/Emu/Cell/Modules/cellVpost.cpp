@@ -9,6 +9,7 @@ extern "C"
 }
 
 #include "cellVpost.h"
+#include "video_converter.h"
 
 LOG_CHANNEL(cellVpost);
 
@@ -113,26 +114,13 @@ s32 cellVpostExec(u32 handle, vm::cptr<u8> inPicBuff, vm::cptr<CellVpostCtrlPara
 	picInfo->reserved1 = 0;
 	picInfo->reserved2 = 0;
 
-	//u64 stamp0 = get_guest_system_time();
-	std::unique_ptr<u8[]> pA(new u8[w*h]);
+	u8* const in = const_cast<u8*>(inPicBuff.get_ptr());
 
-	memset(pA.get(), ctrlParam->outAlpha, w*h);
+	const video_image in_image{AV_PIX_FMT_YUV420P, static_cast<u32>(w), h, {in, in + w * h, in + w * h * 5 / 4}, {w, w / 2, w / 2}};
+	const video_image out_image{AV_PIX_FMT_RGBA, ow, oh, {outPicBuff.get_ptr()}, {static_cast<s32>(ow * 4)}};
 
-	//u64 stamp1 = get_guest_system_time();
+	fxm::get_always<video_converter>()->yuv420_to_rgb(in_image, out_image, ctrlParam->outAlpha, SWS_BILINEAR);
 
-	vpost->sws = sws_getCachedContext(vpost->sws, w, h, AV_PIX_FMT_YUVA420P, ow, oh, AV_PIX_FMT_RGBA, SWS_BILINEAR, NULL, NULL, NULL);
-
-	//u64 stamp2 = get_guest_system_time();
-
-	const u8* in_data[4] = { &inPicBuff[0], &inPicBuff[w * h], &inPicBuff[w * h * 5 / 4], pA.get() };
-	int in_line[4] = { w, w/2, w/2, w };
-	u8* out_data[4] = { outPicBuff.get_ptr(), NULL, NULL, NULL };
-	int out_line[4] = { static_cast<int>(ow*4), 0, 0, 0 };
-
-	sws_scale(vpost->sws, in_data, in_line, 0, h, out_data, out_line);
-
-	//ConLog.Write("cellVpostExec() perf (access=%d, getContext=%d, scale=%d, finalize=%d)",
-		//stamp1 - stamp0, stamp2 - stamp1, stamp3 - stamp2, get_guest_system_time() - stamp3);
 	return CELL_OK;
 }
 
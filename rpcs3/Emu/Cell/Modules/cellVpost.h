@@ -332,15 +332,8 @@ public:
 
 	const bool to_rgba;
 
-	SwsContext* sws{};
-
 	VpostInstance(bool rgba)
 		: to_rgba(rgba)
 	{
 	}
-
-	~VpostInstance()
-	{
-		sws_freeContext(sws);
-	}
 };
@@ -0,0 +1,357 @@
+﻿#include "stdafx.h"
+#include "video_converter.h"
+#include "Utilities/sysinfo.h"
+
+extern "C"
+{
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+}
+
+#include <thread>
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#define VIDEO_USE_AVX2
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#define AVX2_FUNC
+#else
+#define AVX2_FUNC __attribute__((__target__("avx2")))
+#endif
+
+#endif
+
+namespace
+{
+	// Minimal amount of rows in a slice
+	constexpr u32 min_slice_rows = 32;
+
+	// BT.601 limited range to RGB (same coefficients as the swscale default), 8 fractional bits
+	inline u8 yuv_clamp(s32 v)
+	{
+		return static_cast<u8>(std::clamp(v >> 8, 0, 255));
+	}
+
+	// Convert one row of pixels, the channel order is given by the byte offsets of R, G, B, A
+	void yuv420_row(const u8* y, const u8* u, const u8* v, u8* out, u32 begin, u32 end, u32 order[4], u8 alpha)
+	{
+		for (u32 x = begin; x < end; x++)
+		{
+			const s32 c = 298 * (y[x] - 16) + 128;
+			const s32 d = u[x / 2] - 128;
+			const s32 e = v[x / 2] - 128;
+
+			out[x * 4 + order[0]] = yuv_clamp(c + 409 * e);
+			out[x * 4 + order[1]] = yuv_clamp(c - 100 * d - 208 * e);
+			out[x * 4 + order[2]] = yuv_clamp(c + 516 * d);
+			out[x * 4 + order[3]] = alpha;
+		}
+	}
+
+#ifdef VIDEO_USE_AVX2
+	// Compute a*k.lo + b*k.hi + c*kc (16-bit lanes, 8 fractional bits), the pixel order is preserved
+	AVX2_FUNC inline __m256i yuv420_channel_avx2(__m256i a, __m256i b, __m256i k, __m256i c, __m256i kc)
+	{
+		const __m256i round = _mm256_set1_epi32(128);
+		const __m256i zero = _mm256_setzero_si256();
+
+		__m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), k), round);
+		__m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), k), round);
+		lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(c, zero), kc));
+		hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(c, zero), kc));
+
+		return _mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8));
+	}
+
+	// 16 pixels per iteration, returns the amount of pixels converted
+	AVX2_FUNC u32 yuv420_row_avx2(const u8* y, const u8* u, const u8* v, u8* out, u32 width, bool argb, u8 alpha)
+	{
+		const __m256i k_y = _mm256_set1_epi32(298 | 409 << 16); // (c, e) -> r
+		const __m256i k_g = _mm256_set1_epi32(static_cast<s32>(0xff30ff9c)); // (d, e) -> g - c (-100, -208)
+		const __m256i k_b = _mm256_set1_epi32(298 | 516 << 16); // (c, d) -> b
+		const __m256i k_c = _mm256_set1_epi32(298);
+		const __m256i k_zero = _mm256_setzero_si256();
+		const __m256i off_y = _mm256_set1_epi16(16);
+		const __m256i off_uv = _mm256_set1_epi16(128);
+		const __m256i a16 = _mm256_set1_epi16(alpha);
+
+		u32 x = 0;
+
+		for (; x + 16 <= width; x += 16)
+		{
+			const __m256i c = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x))), off_y);
+
+			// Duplicate chroma samples horizontally
+			const __m128i us = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+			const __m128i vs = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+			const __m256i d = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(us, us)), off_uv);
+			const __m256i e = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(vs, vs)), off_uv);
+
+			const __m256i r = yuv420_channel_avx2(c, e, k_y, c, k_zero);
+			const __m256i g = yuv420_channel_avx2(d, e, k_g, c, k_c);
+			const __m256i b = yuv420_channel_avx2(c, d, k_b, c, k_zero);
+
+			// Interleave bytes: (c0, c2) and (c1, c3) pairs, then the pairs
+			const __m256i p0 = argb ? _mm256_packus_epi16(a16, g) : _mm256_packus_epi16(r, b);
+			const __m256i p1 = argb ? _mm256_packus_epi16(r, b) : _mm256_packus_epi16(g, a16);
+			const __m256i q0 = _mm256_unpacklo_epi8(p0, p1);
+			const __m256i q1 = _mm256_unpackhi_epi8(p0, p1);
+			const __m256i lo = _mm256_unpacklo_epi16(q0, q1);
+			const __m256i hi = _mm256_unpackhi_epi16(q0, q1);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+
+		return x;
+	}
+#endif
+
+	u64 get_plane_offset(const video_image& img, u32 plane, u32 row)
+	{
+		const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(img.format));
+
+		if ((plane == 1 || plane == 2) && desc && desc->flags & AV_PIX_FMT_FLAG_PLANAR)
+		{
+			row >>= desc->log2_chroma_h;
+		}
+
+		return u64{row} * img.pitch[plane];
+	}
+}
+
+void video_converter::worker::operator()()
+{
+	while (thread_ctrl::state() != thread_state::aborting)
+	{
+		if (!conv.run_slice(conv.m_job))
+		{
+			thread_ctrl::wait();
+		}
+	}
+}
+
+video_converter::video_converter()
+{
+	// The calling thread processes slices as well
+	const u32 count = std::clamp<u32>(std::thread::hardware_concurrency() / 2, 1, 4) - 1;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		m_workers.emplace_back(std::make_unique<named_thread<worker>>(fmt::format("Video Converter %u", i), worker{*this}));
+	}
+}
+
+video_converter::~video_converter()
+{
+	m_workers.clear();
+
+	for (auto& entry : m_cache)
+	{
+		sws_freeContext(entry.ctx);
+	}
+}
+
+bool video_converter::run_slice(u64 job)
+{
+	const u32 index = static_cast<u16>(job);
+	const u32 slices = static_cast<u16>(job >> 16);
+
+	if (index >= slices)
+	{
+		return false;
+	}
+
+	// Claim the slice (fails if the job was finished and replaced after it was read)
+	if (!m_job.compare_and_swap_test(job, job + 1))
+	{
+		return true;
+	}
+
+	// The job can't complete before this slice is done, so m_func still belongs to it
+	(*m_func.load())(index);
+
+	if (++m_done == slices)
+	{
+		std::lock_guard lock(m_done_mutex);
+		m_done_cond.notify_one();
+	}
+
+	return true;
+}
+
+void video_converter::parallel(u32 slices, const std::function<void(u32)>& func)
+{
+	std::unique_lock lock(m_job_mutex, std::try_to_lock);
+
+	if (!lock || m_workers.empty() || slices <= 1 || slices > 0xffff)
+	{
+		for (u32 i = 0; i < slices; i++)
+		{
+			func(i);
+		}
+
+		return;
+	}
+
+	m_func = &func;
+	m_done = 0;
+
+	// Publish the job (new generation, slice count, first slice)
+	const u64 job = ((m_job >> 32) + 1) << 32 | u64{slices} << 16;
+	m_job.release(job);
+
+	for (auto& w : m_workers)
+	{
+		thread_ctrl::notify(*w);
+	}
+
+	while (run_slice(m_job))
+	{
+	}
+
+	// Wait for the slices taken by the workers
+	if (m_done < slices)
+	{
+		std::lock_guard lock(m_done_mutex);
+
+		while (m_done < slices)
+		{
+			m_done_cond.wait(m_done_mutex);
+		}
+	}
+}
+
+SwsContext* video_converter::get_context(const video_image& in, u32 in_height, const video_image& out, u32 out_height, s32 flags)
+{
+	const u64 key0 = u64{static_cast<u16>(in.format)} | u64{in.width} << 16 | u64{in_height} << 32 | u64{static_cast<u16>(out.format)} << 48;
+	const u64 key1 = u64{out.width} | u64{out_height} << 16 | u64{static_cast<u32>(flags)} << 32;
+
+	{
+		std::lock_guard lock(m_cache_mutex);
+
+		for (auto it = m_cache.begin(); it != m_cache.end(); it++)
+		{
+			if (it->key[0] == key0 && it->key[1] == key1)
+			{
+				SwsContext* ctx = it->ctx;
+				m_cache.erase(it);
+				return ctx;
+			}
+		}
+	}
+
+	SwsContext* ctx = sws_getContext(in.width, in_height, static_cast<AVPixelFormat>(in.format), out.width, out_height, static_cast<AVPixelFormat>(out.format), flags, nullptr, nullptr, nullptr);
+
+	if (!ctx)
+	{
+		fmt::throw_exception("sws_getContext() failed (%dx%d fmt=%d -> %dx%d fmt=%d)" HERE, in.width, in_height, in.format, out.width, out_height, out.format);
+	}
+
+	return ctx;
+}
+
+void video_converter::put_context(const video_image& in, u32 in_height, const video_image& out, u32 out_height, s32 flags, SwsContext* ctx)
+{
+	const u64 key0 = u64{static_cast<u16>(in.format)} | u64{in.width} << 16 | u64{in_height} << 32 | u64{static_cast<u16>(out.format)} << 48;
+	const u64 key1 = u64{out.width} | u64{out_height} << 16 | u64{static_cast<u32>(flags)} << 32;
+
+	std::lock_guard lock(m_cache_mutex);
+
+	// Keep the most recent contexts (enough for all slices of a few format pairs)
+	if (m_cache.size() >= 16)
+	{
+		sws_freeContext(m_cache.front().ctx);
+		m_cache.erase(m_cache.begin());
+	}
+
+	m_cache.push_back({{key0, key1}, ctx});
+}
+
+void video_converter::convert(const video_image& in, const video_image& out, s32 flags)
+{
+	if (flags != SWS_POINT || in.width != out.width || in.height != out.height)
+	{
+		// Scaling and filtering can't be split into independent slices (filters would leave seams)
+		SwsContext* ctx = get_context(in, in.height, out, out.height, flags);
+		sws_scale(ctx, in.data, in.pitch, 0, in.height, out.data, out.pitch);
+		put_context(in, in.height, out, out.height, flags, ctx);
+		return;
+	}
+
+	// Slices of equal even height (except the last one), each converted as a separate picture
+	const u32 count = ::size32(m_workers) + 1;
+	const u32 rows = ::align(std::max(min_slice_rows, (in.height + count - 1) / count), 2);
+	const u32 slices = (in.height + rows - 1) / rows;
+
+	parallel(slices, [&](u32 slice)
+	{
+		const u32 begin = slice * rows;
+		const u32 height = std::min(rows, in.height - begin);
+
+		const u8* in_data[4]{};
+		u8* out_data[4]{};
+
+		for (u32 p = 0; p < 4; p++)
+		{
+			in_data[p] = in.data[p] ? in.data[p] + get_plane_offset(in, p, begin) : nullptr;
+			out_data[p] = out.data[p] ? out.data[p] + get_plane_offset(out, p, begin) : nullptr;
+		}
+
+		SwsContext* ctx = get_context(in, height, out, height, flags);
+		sws_scale(ctx, in_data, in.pitch, 0, height, out_data, out.pitch);
+		put_context(in, height, out, height, flags, ctx);
+	});
+}
+
+void video_converter::yuv420_to_rgb(const video_image& in, const video_image& out, u8 alpha, s32 flags)
+{
+	const bool argb = out.format == AV_PIX_FMT_ARGB;
+
+#ifdef VIDEO_USE_AVX2
+	// Point sampling only (the chroma samples are duplicated like SWS_POINT does)
+	if (flags == SWS_POINT && in.width == out.width && in.height == out.height && utils::has_avx2())
+	{
+		u32 order[4] = {0, 1, 2, 3};
+
+		if (argb)
+		{
+			order[0] = 1, order[1] = 2, order[2] = 3, order[3] = 0;
+		}
+
+		const u32 count = ::size32(m_workers) + 1;
+		const u32 rows = std::max(min_slice_rows, (in.height + count - 1) / count);
+		const u32 slices = (in.height + rows - 1) / rows;
+
+		parallel(slices, [&](u32 slice)
+		{
+			for (u32 row = slice * rows; row < std::min(in.height, (slice + 1) * rows); row++)
+			{
+				const u8* y = in.data[0] + u64{row} * in.pitch[0];
+				const u8* u = in.data[1] + u64{row / 2} * in.pitch[1];
+				const u8* v = in.data[2] + u64{row / 2} * in.pitch[2];
+				u8* dst = out.data[0] + u64{row} * out.pitch[0];
+
+				const u32 done = yuv420_row_avx2(y, u, v, dst, in.width, argb, alpha);
+				yuv420_row(y, u, v, dst, done, in.width, order, alpha);
+			}
+		});
+
+		return;
+	}
+#endif
+
+	// Generic path with a constant alpha plane
+	std::unique_ptr<u8[]> alpha_plane(new u8[in.width * in.height]);
+	std::memset(alpha_plane.get(), alpha, in.width * in.height);
+
+	video_image yuva = in;
+	yuva.format = AV_PIX_FMT_YUVA420P;
+	yuva.data[3] = alpha_plane.get();
+	yuva.pitch[3] = in.width;
+
+	convert(yuva, out, flags);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Utilities/types.h"
+#include "Utilities/Thread.h"
+#include "Utilities/mutex.h"
+#include "Utilities/cond.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct SwsContext;
+
+// Picture in memory (format is AVPixelFormat)
+struct video_image
+{
+	s32 format;
+	u32 width;
+	u32 height;
+	u8* data[4];
+	s32 pitch[4];
+};
+
+// Colour conversion service shared by the video HLE modules (cellVdec, cellVpost)
+// Point sampled conversions without scaling are split into horizontal slices processed by worker threads
+class video_converter
+{
+	struct worker
+	{
+		video_converter& conv;
+
+		void operator()();
+	};
+
+	std::vector<std::unique_ptr<named_thread<worker>>> m_workers;
+
+	// Only one job is processed at a time, other callers run their job alone
+	shared_mutex m_job_mutex;
+
+	// Current job: generation (high 32 bits), slice count (bits 16..31) and next slice index (low 16 bits)
+	atomic_t<u64> m_job{0};
+	atomic_t<u32> m_done{0};
+	atomic_t<const std::function<void(u32)>*> m_func{nullptr};
+
+	// Signalled when the last slice of the job is done
+	shared_mutex m_done_mutex;
+	cond_variable m_done_cond;
+
+	bool run_slice(u64 job);
+
+	// Run func(slice) for each slice, in parallel if possible
+	void parallel(u32 slices, const std::function<void(u32)>& func);
+
+	struct cached_context
+	{
+		u64 key[2];
+		SwsContext* ctx;
+	};
+
+	// Idle swscale contexts (protected by m_cache_mutex), taken out while in use
+	std::vector<cached_context> m_cache;
+	shared_mutex m_cache_mutex;
+
+	SwsContext* get_context(const video_image& in, u32 in_height, const video_image& out, u32 out_height, s32 flags);
+	void put_context(const video_image& in, u32 in_height, const video_image& out, u32 out_height, s32 flags, SwsContext* ctx);
+
+public:
+	video_converter();
+	~video_converter();
+
+	// Convert the picture (scaled to the output size)
+	void convert(const video_image& in, const video_image& out, s32 flags);
+
+	// Convert planar YUV 4:2:0 (in.format is ignored) to 32-bit RGB with constant alpha
+	// The output channel order is given by out.format (AV_PIX_FMT_RGBA or AV_PIX_FMT_ARGB)
+	void yuv420_to_rgb(const video_image& in, const video_image& out, u8 alpha, s32 flags);
+};
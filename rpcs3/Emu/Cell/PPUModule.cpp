@@ -11,6 +11,7 @@
 
 #include "Emu/Cell/PPUOpcodes.h"
 #include "Emu/Cell/PPUAnalyser.h"
+#include "Emu/Cell/PPUProfiler.h"
 
 #include "Emu/Cell/lv2/sys_process.h"
 #include "Emu/Cell/lv2/sys_prx.h"
@@ -156,6 +157,8 @@ static void ppu_initialize_modules(const std::shared_ptr<ppu_linkage_info>& link
 		return;
 	}
 
+	ppu_profiler::init(::size32(ppu_function_manager::get()));
+
 	ppu_initialize_syscalls();
 
 	const std::initializer_list<const ppu_static_module*> registered
@@ -284,8 +287,8 @@ static void ppu_initialize_modules(const std::shared_ptr<ppu_linkage_info>& link
 		vm::write32(addr + 0, addr);
 		vm::write32(addr + 4, ppu_instructions::BLR());
 
-		// Register the HLE function directly
-		ppu_register_function_at(addr + 0, 4, hle_funcs[index]);
+		// Register the HLE function directly (or the profiling wrapper)
+		ppu_register_function_at(addr + 0, 4, ppu_profiler::is_enabled() && index > 1 ? &ppu_profiler::call_hle : hle_funcs[index]);
 		ppu_register_function_at(addr + 4, 4, nullptr);
 	}
 
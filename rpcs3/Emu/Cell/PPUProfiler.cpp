@@ -0,0 +1,195 @@
+#include "stdafx.h"
+#include "PPUProfiler.h"
+
+#include "Emu/System.h"
+
+#include <chrono>
+
+extern std::string ppu_get_syscall_name(u64 code);
+extern std::vector<std::string> g_ppu_function_names;
+
+namespace
+{
+	bool s_enabled = false;
+
+	std::array<ppu_call_stats, 1024> s_syscalls;
+
+	std::unique_ptr<ppu_call_stats[]> s_hle;
+
+	u32 s_hle_count = 0;
+
+	// Sleep start timepoint of the current thread (0 if not sleeping in a profiled call)
+	thread_local u64 s_tls_sleep_start = 0;
+
+	u64 get_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void reset(ppu_call_stats& stats)
+	{
+		stats.calls = 0;
+		stats.total = 0;
+		stats.max = 0;
+		stats.blocked = 0;
+	}
+}
+
+void ppu_profiler::init(u32 hle_count)
+{
+	s_enabled = g_cfg.core.ppu_call_profiler.get();
+
+	for (auto& stats : s_syscalls)
+	{
+		reset(stats);
+	}
+
+	if (hle_count != s_hle_count)
+	{
+		s_hle = std::make_unique<ppu_call_stats[]>(hle_count);
+		s_hle_count = hle_count;
+	}
+	else
+	{
+		for (u32 i = 0; i < s_hle_count; i++)
+		{
+			reset(s_hle[i]);
+		}
+	}
+}
+
+bool ppu_profiler::is_enabled()
+{
+	return s_enabled;
+}
+
+ppu_call_stats& ppu_profiler::syscall(u64 code)
+{
+	return s_syscalls[code % s_syscalls.size()];
+}
+
+bool ppu_profiler::call(ppu_thread& ppu, ppu_function_t func, ppu_call_stats& stats)
+{
+	// Save the state of the outer call (an HLE function may perform a nested call)
+	const u64 outer_sleep = std::exchange(s_tls_sleep_start, 0);
+
+	const u64 start = get_ns();
+	const bool result = func(ppu);
+	const u64 stop = get_ns();
+	const u64 time = stop - start;
+
+	if (const u64 sleep = std::exchange(s_tls_sleep_start, outer_sleep))
+	{
+		stats.blocked += stop - std::max(sleep, start);
+	}
+
+	stats.calls++;
+	stats.total += time;
+	stats.max.fetch_op([&](u64& val)
+	{
+		if (val < time)
+		{
+			val = time;
+		}
+	});
+
+	return result;
+}
+
+bool ppu_profiler::call_hle(ppu_thread& ppu)
+{
+	const auto& funcs = ppu_function_manager::get();
+
+	const u32 index = (ppu.cia - ppu_function_manager::addr) / 8;
+
+	if (UNLIKELY(index >= funcs.size() || index >= s_hle_count))
+	{
+		// Unregistered function handler
+		return funcs[0](ppu);
+	}
+
+	return call(ppu, funcs[index], s_hle[index]);
+}
+
+void ppu_profiler::on_sleep()
+{
+	if (s_enabled && !s_tls_sleep_start)
+	{
+		s_tls_sleep_start = get_ns();
+	}
+}
+
+std::vector<ppu_profiler::entry> ppu_profiler::collect()
+{
+	std::vector<entry> result;
+
+	auto add = [&](std::string name, bool is_syscall, const ppu_call_stats& stats)
+	{
+		if (const u64 calls = stats.calls)
+		{
+			result.emplace_back(entry{std::move(name), is_syscall, calls, stats.total, stats.max, stats.blocked});
+		}
+	};
+
+	for (u32 i = 0; i < s_syscalls.size(); i++)
+	{
+		if (s_syscalls[i].calls)
+		{
+			add(ppu_get_syscall_name(i), true, s_syscalls[i]);
+		}
+	}
+
+	for (u32 i = 0; i < s_hle_count; i++)
+	{
+		if (s_hle[i].calls)
+		{
+			add(i < g_ppu_function_names.size() ? g_ppu_function_names[i] : fmt::format("HLE #%u", i), false, s_hle[i]);
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](const entry& a, const entry& b)
+	{
+		return a.total > b.total;
+	});
+
+	return result;
+}
+
+std::string ppu_profiler::dump(std::string path)
+{
+	if (!s_enabled)
+	{
+		return {};
+	}
+
+	if (path.empty())
+	{
+		path = fs::get_config_dir() + "ppu_profile.csv";
+	}
+
+	const auto entries = collect();
+
+	std::string out = "type,name,calls,total_us,avg_us,max_us,blocked_us\n";
+
+	for (const auto& e : entries)
+	{
+		fmt::append(out, "%s,%s,%llu,%.3f,%.3f,%.3f,%.3f\n", e.is_syscall ? "syscall" : "hle", e.name, e.calls,
+			e.total / 1000., e.total / 1000. / e.calls, e.max / 1000., e.blocked / 1000.);
+	}
+
+	if (!fs::write_file(path, fs::rewrite, out))
+	{
+		LOG_ERROR(PPU, "Failed to write profile to '%s' (%s)", path, fs::g_tls_error);
+		return {};
+	}
+
+	for (std::size_t i = 0; i < entries.size() && i < 10; i++)
+	{
+		const auto& e = entries[i];
+		LOG_NOTICE(PPU, "#%zu %s: calls=%llu, total=%.3fms, avg=%.3fus, max=%.3fus, blocked=%.3fms", i + 1, e.name, e.calls,
+			e.total / 1000000., e.total / 1000. / e.calls, e.max / 1000., e.blocked / 1000000.);
+	}
+
+	LOG_SUCCESS(PPU, "Profile saved to '%s' (%zu entries)", path, entries.size());
+	return path;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "PPUFunction.h"
+
+#include <string>
+#include <vector>
+
+// Call statistics of a single syscall or HLE function (host time in nanoseconds)
+struct ppu_call_stats
+{
+	atomic_t<u64> calls{0};
+	atomic_t<u64> total{0};
+	atomic_t<u64> max{0};
+	atomic_t<u64> blocked{0}; // Time spent sleeping in lv2 during the call
+};
+
+// Optional PPU syscall and HLE function profiler ("PPU Call Profiler" option)
+namespace ppu_profiler
+{
+	struct entry
+	{
+		std::string name;
+		bool is_syscall;
+		u64 calls;
+		u64 total;
+		u64 max;
+		u64 blocked;
+	};
+
+	// Reset statistics and apply the setting (called on boot, before any wrapper is installed)
+	void init(u32 hle_count);
+
+	bool is_enabled();
+
+	ppu_call_stats& syscall(u64 code);
+
+	// Execute the function and record its statistics
+	bool call(ppu_thread& ppu, ppu_function_t func, ppu_call_stats& stats);
+
+	// Wrapper for HLE functions, the function index is determined from the OPD address in CIA
+	bool call_hle(ppu_thread& ppu);
+
+	// Notify that the current thread is going to sleep (from lv2_obj::sleep_timeout)
+	void on_sleep();
+
+	// Get all called functions sorted by total time
+	std::vector<entry> collect();
+
+	// Write the report to the file (default path if empty), return the path
+	std::string dump(std::string path = {});
+}
@@ -11,6 +11,7 @@
 #include "PPUAnalyser.h"
 #include "PPUModule.h"
 #include "SPURecompiler.h"
+#include "Emu/CPU/CPUTimeStats.h"
 #include "lv2/sys_sync.h"
 #include "lv2/sys_prx.h"
 #include "Utilities/GDBDebugServer.h"
@@ -1022,6 +1023,8 @@ static T ppu_load_acquire_reservation(ppu_thread& ppu, u32 addr)
 
 	vm::passive_unlock(ppu);
 
+	cpu_activity_scope scope(cpu_activity::reservation);
+
 	for (u64 i = 0;; i++)
 	{
 		ppu.rtime = vm::reservation_acquire(addr, sizeof(T));
@@ -1360,10 +1363,13 @@ extern void ppu_initialize(const ppu_module& info)
 		return;
 	}
 
-	// Link table
-	static const std::unordered_map<std::string, u64> s_link_table = []()
+	// Account compilation time if called from a PPU thread (PRX loading)
+	cpu_activity_scope scope(cpu_activity::jit);
+
+	// Link table (rebuilt on every call: syscall entries depend on the profiler setting of the current boot)
+	const std::unordered_map<std::string, u64> link_table = []()
 	{
-		std::unordered_map<std::string, u64> link_table
+		std::unordered_map<std::string, u64> table
 		{
 			{ "__mptr", (u64)&vm::g_base_addr },
 			{ "__cptr", (u64)&vm::g_exec_addr },
@@ -1394,12 +1400,12 @@ extern void ppu_initialize(const ppu_module& info)
 		{
 			if (auto sc = ppu_get_syscall(index))
 			{
-				link_table.emplace(fmt::format("%s", ppu_syscall_code(index)), (u64)sc);
-				link_table.emplace(fmt::format("syscall_%u", index), (u64)sc);
+				table.emplace(fmt::format("%s", ppu_syscall_code(index)), (u64)sc);
+				table.emplace(fmt::format("syscall_%u", index), (u64)sc);
 			}
 		}
 
-		return link_table;
+		return table;
 	}();
 
 	// Get cache path for this executable
@@ -1484,7 +1490,7 @@ extern void ppu_initialize(const ppu_module& info)
 		// Initialize compiler instance
 		if (!jit && get_current_cpu_thread())
 		{
-			jit = std::make_shared<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu);
+			jit = std::make_shared<jit_compiler>(link_table, g_cfg.core.llvm_cpu);
 		}
 
 		// First function in current module part
@@ -3,6 +3,7 @@
 
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
+#include "Emu/CPU/CPUTimeStats.h"
 #include "Crypto/sha1.h"
 #include "Utilities/StrUtil.h"
 #include "Utilities/JIT.h"
@@ -1122,7 +1123,10 @@ void spu_recompiler_base::dispatch(spu_thread& spu, void*, u8* rip)
 	}
 
 	// Compile
-	spu.jit->make_function(spu.jit->analyse(spu._ptr<u32>(0), spu.pc));
+	{
+		cpu_activity_scope scope(cpu_activity::jit);
+		spu.jit->make_function(spu.jit->analyse(spu._ptr<u32>(0), spu.pc));
+	}
 
 	// Diagnostic
 	if (g_cfg.core.spu_block_size == spu_block_size_type::giga)
@@ -6,6 +6,7 @@
 #include "Emu/System.h"
 
 #include "Emu/IdManager.h"
+#include "Emu/CPU/CPUTimeStats.h"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/ErrorCodes.h"
 #include "Emu/Cell/lv2/sys_spu.h"
@@ -23,6 +24,7 @@
 #include <cfenv>
 #include <atomic>
 #include <thread>
+#include <deque>
 
 // Verify AVX availability for TSX transactions
 static const bool s_tsx_avx = utils::has_avx();
@@ -110,83 +112,314 @@ namespace spu
 {
 	namespace scheduler
 	{
-		std::array<std::atomic<u8>, 65536> atomic_instruction_table = {};
 		constexpr u32 native_jiffy_duration_us = 1500; //About 1ms resolution with a half offset
 
-		void acquire_pc_address(spu_thread& spu, u32 pc, u32 timeout_ms = 3)
+		// Limits the number of SPU threads executing guest code simultaneously (one execution slot per thread)
+		struct slot_scheduler
 		{
-			const u8 max_concurrent_instructions = (u8)g_cfg.core.preferred_spu_threads;
-			const u32 pc_offset = pc >> 2;
+			struct waiter
+			{
+				spu_thread* spu;
+				atomic_t<bool>* granted;
+			};
+
+			shared_mutex mutex;
+
+			// Threads waiting for a slot (FIFO)
+			std::deque<waiter> queue;
+
+			atomic_t<u32> waiters{0};
+
+			// Negative if threads took a slot after waiting for a whole time slice
+			s32 free;
+
+			slot_scheduler()
+			{
+				// Leave host threads for PPU and RSX if not specified
+				const u32 host_threads = std::thread::hardware_concurrency();
+
+				free = g_cfg.core.preferred_spu_threads ? +g_cfg.core.preferred_spu_threads : std::max<u32>(host_threads > 2 ? host_threads - 2 : 0, 2);
+
+				LOG_NOTICE(SPU, "SPU scheduler: %d execution slots", free);
+			}
+		};
+
+		// Current thread's slot state
+		struct slot_state
+		{
+			std::shared_ptr<slot_scheduler> sched;
+
+			bool held = false;
+
+			// Time when the slot was acquired
+			u64 since = 0;
+		};
+
+		thread_local slot_state s_tls_slot;
+
+		void acquire(spu_thread& spu)
+		{
+			auto& st = s_tls_slot;
+
+			if (!st.sched || st.held)
+			{
+				return;
+			}
 
-			if (atomic_instruction_table[pc_offset].load(std::memory_order_consume) >= max_concurrent_instructions)
+			auto& sched = *st.sched;
+
+			atomic_t<bool> granted{false};
+
+			{
+				std::lock_guard lock(sched.mutex);
+
+				if (sched.free > 0 && sched.queue.empty())
+				{
+					sched.free--;
+					st.held = true;
+					st.since = get_system_time();
+					return;
+				}
+
+				sched.queue.push_back({&spu, &granted});
+				sched.waiters++;
+			}
+
+			const bool was_waiting = !!(spu.state & cpu_flag::wait);
+
+			if (!was_waiting)
 			{
 				spu.state += cpu_flag::wait;
+			}
+
+			const u64 slice = g_cfg.core.spu_delay_penalty * 1000u;
+			const u64 start = get_system_time();
 
-				if (timeout_ms > 0)
+			while (!granted)
+			{
+				const bool stopped = spu.is_stopped();
+
+				// Don't wait longer than a time slice (the slot holders may never reach a checkpoint)
+				if (stopped || get_system_time() - start >= slice)
 				{
-					const u64 timeout = timeout_ms * 1000u; //convert to microseconds
-					const u64 start = get_system_time();
-					auto remaining = timeout;
+					std::lock_guard lock(sched.mutex);
 
-					while (atomic_instruction_table[pc_offset].load(std::memory_order_consume) >= max_concurrent_instructions)
+					if (!granted)
 					{
-						if (remaining >= native_jiffy_duration_us)
-							std::this_thread::sleep_for(1ms);
-						else
-							std::this_thread::yield();
+						sched.queue.erase(std::find_if(sched.queue.begin(), sched.queue.end(), [&](const slot_scheduler::waiter& w) { return w.granted == &granted; }));
+						sched.waiters--;
 
-						const auto now = get_system_time();
-						const auto elapsed = now - start;
-
-						if (elapsed > timeout) break;
-						remaining = timeout - elapsed;
+						if (!stopped)
+						{
+							// Take a slot anyway, it is given back by the next release()
+							sched.free--;
+							st.held = true;
+							st.since = get_system_time();
+						}
 					}
+
+					break;
 				}
-				else
+
+				thread_ctrl::wait_for(slice - (get_system_time() - start));
+			}
+
+			if (granted)
+			{
+				st.held = true;
+				st.since = get_system_time();
+			}
+
+			if (!was_waiting)
+			{
+				// Clear the wait flag and process the flags raised while waiting
+				spu.check_state();
+			}
+		}
+
+		void release()
+		{
+			auto& st = s_tls_slot;
+
+			if (!st.held)
+			{
+				return;
+			}
+
+			st.held = false;
+
+			auto& sched = *st.sched;
+
+			std::lock_guard lock(sched.mutex);
+
+			if (sched.free < 0 || sched.queue.empty())
+			{
+				sched.free++;
+				return;
+			}
+
+			// Hand the slot over to the first waiter
+			const auto next = sched.queue.front();
+			sched.queue.pop_front();
+			sched.waiters--;
+
+			*next.granted = true;
+			next.spu->notify();
+		}
+
+		// Give the slot to another thread if the time slice expired
+		void checkpoint(spu_thread& spu)
+		{
+			auto& st = s_tls_slot;
+
+			if (UNLIKELY(!st.held))
+			{
+				acquire(spu);
+				return;
+			}
+
+			if (UNLIKELY(st.sched->waiters) && get_system_time() - st.since >= g_cfg.core.spu_delay_penalty * 1000u)
+			{
+				release();
+				acquire(spu);
+			}
+		}
+
+		// Execution slot owner for cpu_task()
+		struct slot_guard
+		{
+			slot_guard(spu_thread& spu)
+			{
+				s_tls_slot = {};
+				s_tls_slot.sched = fxm::get_always<slot_scheduler>();
+				acquire(spu);
+			}
+
+			~slot_guard()
+			{
+				release();
+				s_tls_slot.sched.reset();
+			}
+		};
+
+		// Releases the slot while the thread is blocked, reacquires it at the end of the scope
+		struct slot_yield
+		{
+			spu_thread* spu = nullptr;
+
+			void release(spu_thread& _spu)
+			{
+				if (!spu && s_tls_slot.held)
 				{
-					//Slight pause if function is overburdened
-					const auto count = atomic_instruction_table[pc_offset].load(std::memory_order_consume) * 100ull;
-					busy_wait(count);
+					spu = &_spu;
+					scheduler::release();
 				}
+			}
 
-				if (spu.test_stopped())
+			~slot_yield()
+			{
+				if (spu)
 				{
-					spu_runtime::g_escape(&spu);
+					acquire(*spu);
 				}
 			}
+		};
+	}
+}
 
-			atomic_instruction_table[pc_offset]++;
-		}
+namespace
+{
+	// Poll the channel before blocking for as long as its recent waits suggest
+	class spu_adaptive_wait
+	{
+		spu_channel_wait_stats& m_stats;
 
-		void release_pc_address(u32 pc)
-		{
-			const u32 pc_offset = pc >> 2;
+		u64 m_start = 0;
+
+		u32 m_phase = 0;
+
+	public:
+		// Busy wait if the channel is usually ready within this time (us)
+		static constexpr u64 spin_max = 10;
+
+		// Yield the host thread if the channel is usually ready within this time (us)
+		static constexpr u64 yield_max = 200;
 
-			atomic_instruction_table[pc_offset]--;
+		spu_adaptive_wait(spu_channel_wait_stats& stats)
+			: m_stats(stats)
+		{
 		}
 
-		struct concurrent_execution_watchdog
+		spu_adaptive_wait(const spu_adaptive_wait&) = delete;
+
+		// Returns true if the condition was satisfied, otherwise the caller should block
+		template <typename F>
+		bool poll(F&& ready)
 		{
-			u32 pc = 0;
-			bool active = false;
+			m_start = get_system_time();
+
+			const u64 avg = m_stats.avg_time;
+			const u64 until = m_start + avg * 2 + 2;
+
+			if (avg <= spin_max)
+			{
+				do
+				{
+					if (ready())
+					{
+						return true;
+					}
+
+					busy_wait(300);
+				}
+				while (get_system_time() < until);
+			}
 
-			concurrent_execution_watchdog(spu_thread& spu)
-				:pc(spu.pc)
+			m_phase = 1;
+
+			if (avg <= yield_max)
 			{
-				if (g_cfg.core.preferred_spu_threads > 0)
+				do
 				{
-					acquire_pc_address(spu, pc, (u32)g_cfg.core.spu_delay_penalty);
-					active = true;
+					if (ready())
+					{
+						return true;
+					}
+
+					std::this_thread::yield();
 				}
+				while (get_system_time() < until);
 			}
 
-			~concurrent_execution_watchdog()
+			m_phase = 2;
+			return ready();
+		}
+
+		~spu_adaptive_wait()
+		{
+			if (m_start)
 			{
-				if (active)
-					release_pc_address(pc);
+				m_stats.add(get_system_time() - m_start, m_phase);
 			}
-		};
+		}
+	};
+}
+
+const char* spu_channel_wait_stats::get_name(u32 type)
+{
+	switch (type)
+	{
+	case in_mbox: return "SPU_RdInMbox";
+	case tag_stat: return "MFC_RdTagStat";
+	case atomic_stat: return "MFC_RdAtomicStat";
+	case stall_stat: return "MFC_RdListStallStat";
+	case snr1: return "SPU_RdSigNotify1";
+	case snr2: return "SPU_RdSigNotify2";
+	case event: return "SPU_RdEventStat";
+	case reservation: return "SPU_RdEventStat (LR)";
 	}
+
+	return "???";
 }
 
 const auto spu_putllc_tx = build_function_asm<u32(*)(u32 raddr, u64 rtime, const void* _old, const void* _new)>([](asmjit::X86Assembler& c, auto& args)
@@ -923,7 +1156,7 @@ void spu_int_ctrl_t::set(u64 ints)
 	// notify if at least 1 bit was set
 	if (ints && ~stat.fetch_or(ints) & ints && tag)
 	{
-		reader_lock rlock(id_manager::g_mutex);
+		reader_lock rlock(idm::get_mutex<lv2_obj>().reader());
 
 		if (tag)
 		{
@@ -994,6 +1227,14 @@ std::string spu_thread::dump() const
 	fmt::append(ret, "\nMFC Stall: 0x%08x", ch_stall_mask);
 	fmt::append(ret, "\nMFC Queue Size: %u", mfc_size);
 
+	for (u32 i = 0; i < ch_wait_stats.size(); i++)
+	{
+		if (const auto& s = ch_wait_stats[i]; s.waits)
+		{
+			fmt::append(ret, "\nWait %s: %u (spin %u, yield %u, block %u), avg %u us, total %u us", spu_channel_wait_stats::get_name(i), s.waits, s.spins, s.yields, s.blocks, s.avg_time, s.total_time);
+		}
+	}
+
 	for (u32 i = 0; i < 16; i++)
 	{
 		if (i < mfc_size)
@@ -1125,6 +1366,9 @@ void spu_thread::cpu_task()
 		return fmt::format("%s [0x%05x]", thread_ctrl::get_name(), cpu->pc);
 	};
 
+	// Take an execution slot
+	spu::scheduler::slot_guard slot(*this);
+
 	if (jit)
 	{
 		// Register SPU runtime user
@@ -1169,9 +1413,28 @@ void spu_thread::cpu_task()
 		}
 	}
 
+	for (u32 i = 0; i < ch_wait_stats.size(); i++)
+	{
+		if (const auto& s = ch_wait_stats[i]; s.waits)
+		{
+			LOG_NOTICE(SPU, "Stats: %s: %u waits (spin %u, yield %u, block %u), total %u us", spu_channel_wait_stats::get_name(i), s.waits, s.spins, s.yields, s.blocks, s.total_time);
+		}
+	}
+
 	cpu_stop();
 }
 
+void spu_thread::cpu_sleep()
+{
+	// Don't hold the execution slot while suspended
+	spu::scheduler::release();
+}
+
+void spu_thread::cpu_wake()
+{
+	spu::scheduler::acquire(*this);
+}
+
 void spu_thread::cpu_mem()
 {
 	//vm::passive_lock(*this);
@@ -1776,6 +2039,9 @@ bool spu_thread::process_mfc_cmd()
 	// Stall infinitely if MFC queue is full
 	while (UNLIKELY(mfc_size >= 16))
 	{
+		cpu_activity_scope scope(cpu_activity::channel_wait);
+		spu::scheduler::slot_yield yield;
+
 		state += cpu_flag::wait;
 
 		if (is_stopped())
@@ -1783,10 +2049,11 @@ bool spu_thread::process_mfc_cmd()
 			return false;
 		}
 
+		yield.release(*this);
 		thread_ctrl::wait();
 	}
 
-	spu::scheduler::concurrent_execution_watchdog watchdog(*this);
+	spu::scheduler::checkpoint(*this);
 	LOG_TRACE(SPU, "DMAC: cmd=%s, lsa=0x%x, ea=0x%llx, tag=0x%x, size=0x%x", ch_mfc_cmd.cmd, ch_mfc_cmd.lsa, ch_mfc_cmd.eal, ch_mfc_cmd.tag, ch_mfc_cmd.size);
 
 	switch (ch_mfc_cmd.cmd)
@@ -1804,6 +2071,8 @@ bool spu_thread::process_mfc_cmd()
 		{
 			rtime = vm::reservation_acquire(addr, 128) & -128;
 
+			spu::scheduler::slot_yield yield;
+
 			while (cmp_rdata(rdata, data) && (vm::reservation_acquire(addr, 128)) == rtime)
 			{
 				state += cpu_flag::wait;
@@ -1813,6 +2082,7 @@ bool spu_thread::process_mfc_cmd()
 					break;
 				}
 
+				yield.release(*this);
 				thread_ctrl::wait_for(500);
 			}
 
@@ -1843,6 +2113,7 @@ bool spu_thread::process_mfc_cmd()
 
 					while (vm::reservation_acquire(addr, 128) & 127)
 					{
+						cpu_activity_scope scope(cpu_activity::reservation);
 						busy_wait(100);
 					}
 
@@ -2201,6 +2472,9 @@ u32 spu_thread::get_ch_count(u32 ch)
 {
 	LOG_TRACE(SPU, "get_ch_count(ch=%d [%s])", ch, ch < 128 ? spu_ch_name[ch] : "???");
 
+	// Channel count polling loops may not issue MFC commands for a long time
+	spu::scheduler::checkpoint(*this);
+
 	switch (ch)
 	{
 	case SPU_WrOutMbox:       return ch_out_mbox.get_count() ^ 1;
@@ -2223,16 +2497,23 @@ s64 spu_thread::get_ch_value(u32 ch)
 {
 	LOG_TRACE(SPU, "get_ch_value(ch=%d [%s])", ch, ch < 128 ? spu_ch_name[ch] : "???");
 
-	auto read_channel = [&](spu_channel& channel) -> s64
+	// Non-blocking reads (such as the decrementer) can be polled in a loop
+	spu::scheduler::checkpoint(*this);
+
+	auto read_channel = [&](spu_channel& channel, u32 type) -> s64
 	{
+		cpu_activity_scope scope(cpu_activity::channel_wait);
+		spu::scheduler::slot_yield yield;
+		spu_adaptive_wait wait(ch_wait_stats[type]);
+
 		if (channel.get_count() == 0)
 		{
 			state += cpu_flag::wait;
-		}
 
-		for (int i = 0; i < 10 && channel.get_count() == 0; i++)
-		{
-			busy_wait();
+			wait.poll([&]
+			{
+				return channel.get_count() != 0;
+			});
 		}
 
 		u32 out = 0;
@@ -2244,6 +2525,7 @@ s64 spu_thread::get_ch_value(u32 ch)
 				return -1;
 			}
 
+			yield.release(*this);
 			thread_ctrl::wait();
 		}
 
@@ -2259,18 +2541,22 @@ s64 spu_thread::get_ch_value(u32 ch)
 	}
 	case SPU_RdInMbox:
 	{
+		cpu_activity_scope scope(cpu_activity::channel_wait);
+		spu::scheduler::slot_yield yield;
+		spu_adaptive_wait wait(ch_wait_stats[spu_channel_wait_stats::in_mbox]);
+
 		if (ch_in_mbox.get_count() == 0)
 		{
 			state += cpu_flag::wait;
+
+			wait.poll([&]
+			{
+				return ch_in_mbox.get_count() != 0;
+			});
 		}
 
 		while (true)
 		{
-			for (int i = 0; i < 10 && ch_in_mbox.get_count() == 0; i++)
-			{
-				busy_wait();
-			}
-
 			u32 out = 0;
 
 			if (const uint old_count = ch_in_mbox.try_pop(out))
@@ -2289,6 +2575,7 @@ s64 spu_thread::get_ch_value(u32 ch)
 				return -1;
 			}
 
+			yield.release(*this);
 			thread_ctrl::wait();
 		}
 	}
@@ -2303,7 +2590,7 @@ s64 spu_thread::get_ch_value(u32 ch)
 		}
 
 		// Will stall infinitely
-		return read_channel(ch_tag_stat);
+		return read_channel(ch_tag_stat, spu_channel_wait_stats::tag_stat);
 	}
 
 	case MFC_RdTagMask:
@@ -2313,12 +2600,12 @@ s64 spu_thread::get_ch_value(u32 ch)
 
 	case SPU_RdSigNotify1:
 	{
-		return read_channel(ch_snr1);
+		return read_channel(ch_snr1, spu_channel_wait_stats::snr1);
 	}
 
 	case SPU_RdSigNotify2:
 	{
-		return read_channel(ch_snr2);
+		return read_channel(ch_snr2, spu_channel_wait_stats::snr2);
 	}
 
 	case MFC_RdAtomicStat:
@@ -2331,7 +2618,7 @@ s64 spu_thread::get_ch_value(u32 ch)
 		}
 
 		// Will stall infinitely
-		return read_channel(ch_atomic_stat);
+		return read_channel(ch_atomic_stat, spu_channel_wait_stats::atomic_stat);
 	}
 
 	case MFC_RdListStallStat:
@@ -2344,7 +2631,7 @@ s64 spu_thread::get_ch_value(u32 ch)
 		}
 
 		// Will stall infinitely
-		return read_channel(ch_stall_stat);
+		return read_channel(ch_stall_stat, spu_channel_wait_stats::stall_stat);
 	}
 
 	case SPU_RdDec:
@@ -2392,6 +2679,19 @@ s64 spu_thread::get_ch_value(u32 ch)
 				fmt::throw_exception("Unexpected: reservation notifier lock failed");
 			}
 
+			cpu_activity_scope scope(cpu_activity::reservation);
+			spu::scheduler::slot_yield yield;
+			spu_adaptive_wait wait(ch_wait_stats[spu_channel_wait_stats::reservation]);
+
+			state += cpu_flag::wait;
+
+			wait.poll([&]
+			{
+				return get_events() != 0;
+			});
+
+			u64 timeout = 100;
+
 			while (res = get_events(), !res)
 			{
 				state += cpu_flag::wait;
@@ -2401,13 +2701,31 @@ s64 spu_thread::get_ch_value(u32 ch)
 					return -1;
 				}
 
-				pseudo_lock.wait(100);
+				yield.release(*this);
+				pseudo_lock.wait(timeout);
+
+				if (g_cfg.core.spu_reservation_backoff)
+				{
+					// Writers notify the waiters, polling only catches plain stores
+					timeout = std::min<u64>(timeout * 2, 1600);
+				}
 			}
 
 			check_state();
 			return res;
 		}
 
+		cpu_activity_scope scope(cpu_activity::channel_wait);
+		spu::scheduler::slot_yield yield;
+		spu_adaptive_wait wait(ch_wait_stats[spu_channel_wait_stats::event]);
+
+		state += cpu_flag::wait;
+
+		wait.poll([&]
+		{
+			return get_events() != 0;
+		});
+
 		while (res = get_events(true), !res)
 		{
 			state += cpu_flag::wait;
@@ -2417,6 +2735,7 @@ s64 spu_thread::get_ch_value(u32 ch)
 				return -1;
 			}
 
+			yield.release(*this);
 			thread_ctrl::wait_for(100);
 		}
 
@@ -2453,6 +2772,9 @@ bool spu_thread::set_ch_value(u32 ch, u32 value)
 		{
 			while (!ch_out_intr_mbox.try_push(value))
 			{
+				cpu_activity_scope scope(cpu_activity::channel_wait);
+				spu::scheduler::slot_yield yield;
+
 				state += cpu_flag::wait;
 
 				if (is_stopped())
@@ -2460,6 +2782,7 @@ bool spu_thread::set_ch_value(u32 ch, u32 value)
 					return false;
 				}
 
+				yield.release(*this);
 				thread_ctrl::wait();
 			}
 
@@ -2604,6 +2927,9 @@ bool spu_thread::set_ch_value(u32 ch, u32 value)
 	{
 		while (!ch_out_mbox.try_push(value))
 		{
+			cpu_activity_scope scope(cpu_activity::channel_wait);
+			spu::scheduler::slot_yield yield;
+
 			state += cpu_flag::wait;
 
 			if (is_stopped())
@@ -2611,6 +2937,7 @@ bool spu_thread::set_ch_value(u32 ch, u32 value)
 				return false;
 			}
 
+			yield.release(*this);
 			thread_ctrl::wait();
 		}
 
@@ -2806,6 +3133,8 @@ bool spu_thread::stop_and_signal(u32 code)
 		}
 
 		// HACK: wait for executable code
+		spu::scheduler::slot_yield yield;
+
 		while (!_ref<u32>(pc))
 		{
 			state += cpu_flag::wait;
@@ -2815,6 +3144,7 @@ bool spu_thread::stop_and_signal(u32 code)
 				return false;
 			}
 
+			yield.release(*this);
 			thread_ctrl::wait_for(1000);
 		}
 
@@ -2824,7 +3154,9 @@ bool spu_thread::stop_and_signal(u32 code)
 
 	case 0x001:
 	{
+		spu::scheduler::slot_yield yield;
 		state += cpu_flag::wait;
+		yield.release(*this);
 		thread_ctrl::wait_for(1000); // hack
 		check_state();
 		return true;
@@ -2862,6 +3194,8 @@ bool spu_thread::stop_and_signal(u32 code)
 
 		std::shared_ptr<lv2_event_queue> queue;
 
+		spu::scheduler::slot_yield yield;
+
 		state += cpu_flag::wait;
 
 		while (true)
@@ -2876,10 +3210,11 @@ bool spu_thread::stop_and_signal(u32 code)
 					return false;
 				}
 
+				yield.release(*this);
 				thread_ctrl::wait();
 			}
 
-			reader_lock rlock(id_manager::g_mutex);
+			reader_lock rlock(idm::get_mutex<lv2_obj>().reader());
 
 			std::lock_guard lock(group->mutex);
 
@@ -2910,7 +3245,9 @@ bool spu_thread::stop_and_signal(u32 code)
 
 			std::lock_guard qlock(queue->mutex);
 
-			if (queue->events.empty())
+			lv2_event event;
+
+			if (!queue->try_receive(event))
 			{
 				queue->sq.emplace_back(this);
 				group->run_state = SPU_THREAD_GROUP_STATUS_WAITING;
@@ -2929,12 +3266,10 @@ bool spu_thread::stop_and_signal(u32 code)
 			else
 			{
 				// Return the event immediately
-				const auto event = queue->events.front();
 				const auto data1 = static_cast<u32>(std::get<1>(event));
 				const auto data2 = static_cast<u32>(std::get<2>(event));
 				const auto data3 = static_cast<u32>(std::get<3>(event));
 				ch_in_mbox.set_values(4, CELL_OK, data1, data2, data3);
-				queue->events.pop_front();
 				check_state();
 				return true;
 			}
@@ -2949,6 +3284,7 @@ bool spu_thread::stop_and_signal(u32 code)
 
 			if (!state.test_and_reset(cpu_flag::signal))
 			{
+				yield.release(*this);
 				thread_ctrl::wait();
 			}
 			else
@@ -3026,17 +3362,17 @@ bool spu_thread::stop_and_signal(u32 code)
 
 		std::lock_guard qlock(queue->mutex);
 
-		if (queue->events.empty())
+		lv2_event event;
+
+		if (!queue->events.try_pop(event))
 		{
 			return ch_in_mbox.set_values(1, CELL_EBUSY), true;
 		}
 
-		const auto event = queue->events.front();
 		const auto data1 = static_cast<u32>(std::get<1>(event));
 		const auto data2 = static_cast<u32>(std::get<2>(event));
 		const auto data3 = static_cast<u32>(std::get<3>(event));
 		ch_in_mbox.set_values(4, CELL_OK, data1, data2, data3);
-		queue->events.pop_front();
 		return true;
 	}
 
@@ -3048,6 +3384,10 @@ bool spu_thread::stop_and_signal(u32 code)
 			fmt::throw_exception("STOP code 0x100: Out_MBox is not empty" HERE);
 		}
 
+		// Let the threads waiting for an execution slot run first
+		spu::scheduler::slot_yield yield;
+		yield.release(*this);
+
 		std::atomic_thread_fence(std::memory_order_seq_cst);
 		return true;
 	}
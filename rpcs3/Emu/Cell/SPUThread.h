@@ -370,6 +370,48 @@ struct spu_int_ctrl_t
 	}
 };
 
+// Statistics of blocking channel reads, used to choose the wait method
+struct spu_channel_wait_stats
+{
+	enum type : u32
+	{
+		in_mbox,
+		tag_stat,
+		atomic_stat,
+		stall_stat,
+		snr1,
+		snr2,
+		event,
+		reservation,
+
+		type_count
+	};
+
+	static const char* get_name(u32 type);
+
+	u64 avg_time = 0; // Recent wait duration (us, exponential moving average)
+	u64 total_time = 0; // Total wait duration (us)
+	u32 waits = 0;
+	u32 spins = 0; // Satisfied during busy wait
+	u32 yields = 0; // Satisfied during host thread yield
+	u32 blocks = 0; // Went to sleep
+
+	// Record completed wait (phase 0: spin, 1: yield, 2: block)
+	void add(u64 time, u32 phase)
+	{
+		avg_time = (avg_time * 7 + time) / 8;
+		total_time += time;
+		waits++;
+
+		switch (phase)
+		{
+		case 0: spins++; break;
+		case 1: yields++; break;
+		default: blocks++; break;
+		}
+	}
+};
+
 struct spu_imm_table_t
 {
 	v128 sldq_pshufb[32]; // table for SHLQBYBI, SHLQBY, SHLQBYI instructions
@@ -500,6 +542,8 @@ public:
 	virtual std::string get_name() const override;
 	virtual std::string dump() const override;
 	virtual void cpu_task() override final;
+	virtual void cpu_sleep() override;
+	virtual void cpu_wake() override;
 	virtual void cpu_mem() override;
 	virtual void cpu_unmem() override;
 	virtual ~spu_thread() override;
@@ -579,6 +623,8 @@ public:
 	u64 block_recover = 0;
 	u64 block_failure = 0;
 
+	std::array<spu_channel_wait_stats, spu_channel_wait_stats::type_count> ch_wait_stats{};
+
 	u64 saved_native_sp = 0; // Host thread's stack pointer for emulated longjmp
 
 	u8* memory_base_addr = vm::g_base_addr;
@@ -3,6 +3,7 @@
 #include "Emu/Memory/vm_ptr.h"
 
 #include "Emu/Cell/PPUFunction.h"
+#include "Emu/Cell/PPUProfiler.h"
 #include "Emu/Cell/ErrorCodes.h"
 #include "Emu/Cell/MFC.h"
 #include "sys_sync.h"
@@ -969,9 +970,35 @@ void fmt_class_string<CellError>::format(std::string& out, u64 arg)
 	});
 }
 
+template <std::size_t Code>
+static bool profiled_syscall(ppu_thread& ppu)
+{
+	return ppu_profiler::call(ppu, s_ppu_syscall_table[Code], ppu_profiler::syscall(Code));
+}
+
+template <std::size_t... Code>
+static constexpr std::array<ppu_function_t, sizeof...(Code)> make_profiled_syscall_table(std::index_sequence<Code...>)
+{
+	return {&profiled_syscall<Code>...};
+}
+
 extern void ppu_initialize_syscalls()
 {
 	g_ppu_syscall_table = s_ppu_syscall_table;
+
+	if (ppu_profiler::is_enabled())
+	{
+		// Install timing wrappers (also used by LLVM-compiled code, syscalls are linked from this table)
+		static constexpr auto s_profiled_table = make_profiled_syscall_table(std::make_index_sequence<1024>());
+
+		for (std::size_t i = 0; i < g_ppu_syscall_table.size(); i++)
+		{
+			if (g_ppu_syscall_table[i])
+			{
+				g_ppu_syscall_table[i] = s_profiled_table[i];
+			}
+		}
+	}
 }
 
 extern void ppu_execute_syscall(ppu_thread& ppu, u64 code)
@@ -1008,6 +1035,11 @@ DECLARE(lv2_obj::g_waiting);
 
 void lv2_obj::sleep_timeout(cpu_thread& thread, u64 timeout)
 {
+	if (&thread == get_current_cpu_thread())
+	{
+		ppu_profiler::on_sleep();
+	}
+
 	std::lock_guard lock(g_mutex);
 
 	const u64 start_time = get_guest_system_time();
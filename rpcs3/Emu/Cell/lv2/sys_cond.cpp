@@ -157,9 +157,12 @@ error_code sys_cond_signal_to(ppu_thread& ppu, u32 cond_id, u32 thread_id)
 
 	sys_cond.trace("sys_cond_signal_to(cond_id=0x%x, thread_id=0x%x)", cond_id, thread_id);
 
+	// Check the thread before locking the lv2 table (ID tables are not locked in nested fashion)
+	const bool thread_exists = idm::check<named_thread<ppu_thread>>(thread_id) != nullptr;
+
 	const auto cond = idm::check<lv2_obj, lv2_cond>(cond_id, [&](lv2_cond& cond) -> cpu_thread*
 	{
-		if (!idm::check_unlocked<named_thread<ppu_thread>>(thread_id))
+		if (!thread_exists)
 		{
 			return (cpu_thread*)(1);
 		}
@@ -27,20 +27,54 @@ std::shared_ptr<lv2_event_queue> lv2_event_queue::find(u64 ipc_key)
 
 bool lv2_event_queue::send(lv2_event event)
 {
-	std::lock_guard lock(mutex);
-
-	if (sq.empty())
+	if (!waiters)
 	{
-		if (events.size() < this->size)
+		// Fast path: nobody is waiting, store the event without locking
+		if (!events.try_push(event))
+		{
+			return false;
+		}
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (LIKELY(!waiters))
 		{
-			// Save event
-			events.emplace_back(event);
 			return true;
 		}
 
-		return false;
+		// A receiver went to sleep concurrently, make sure it gets the event
+		std::lock_guard lock(mutex);
+
+		for (lv2_event pending; !sq.empty() && events.try_pop(pending);)
+		{
+			deliver(pending);
+		}
+
+		return true;
+	}
+
+	std::lock_guard lock(mutex);
+
+	// Deliver events stored by the fast path first to preserve the order
+	for (lv2_event pending; !sq.empty() && events.try_pop(pending);)
+	{
+		deliver(pending);
+	}
+
+	if (sq.empty())
+	{
+		// Save event
+		return events.try_push(event);
 	}
 
+	deliver(event);
+	return true;
+}
+
+void lv2_event_queue::deliver(const lv2_event& event)
+{
+	waiters--;
+
 	if (type == SYS_PPU_QUEUE)
 	{
 		// Store event in registers
@@ -66,8 +100,6 @@ bool lv2_event_queue::send(lv2_event event)
 		spu.state += cpu_flag::signal;
 		spu.notify();
 	}
-
-	return true;
 }
 
 error_code sys_event_queue_create(vm::ptr<u32> equeue_id, vm::ptr<sys_event_queue_attribute_t> attr, u64 event_queue_key, s32 size)
@@ -212,11 +244,11 @@ error_code sys_event_queue_tryreceive(ppu_thread& ppu, u32 equeue_id, vm::ptr<sy
 
 	s32 count = 0;
 
-	while (queue->sq.empty() && count < size && !queue->events.empty())
+	lv2_event event;
+
+	while (queue->sq.empty() && count < size && queue->events.try_pop(event))
 	{
 		auto& dest = event_array[count++];
-		auto event = queue->events.front();
-		queue->events.pop_front();
 
 		std::tie(dest.source, dest.data1, dest.data2, dest.data3) = event;
 	}
@@ -243,15 +275,16 @@ error_code sys_event_queue_receive(ppu_thread& ppu, u32 equeue_id, vm::ptr<sys_e
 
 		std::lock_guard lock(queue.mutex);
 
-		if (queue.events.empty())
+		lv2_event event;
+
+		if (!queue.try_receive(event))
 		{
 			queue.sq.emplace_back(&ppu);
 			queue.sleep(ppu, timeout);
 			return CELL_EBUSY;
 		}
 
-		std::tie(ppu.gpr[4], ppu.gpr[5], ppu.gpr[6], ppu.gpr[7]) = queue.events.front();
-		queue.events.pop_front();
+		std::tie(ppu.gpr[4], ppu.gpr[5], ppu.gpr[6], ppu.gpr[7]) = event;
 		return {};
 	});
 
@@ -292,6 +325,7 @@ error_code sys_event_queue_receive(ppu_thread& ppu, u32 equeue_id, vm::ptr<sys_e
 					continue;
 				}
 
+				queue->waiters--;
 				ppu.gpr[3] = CELL_ETIMEDOUT;
 				break;
 			}
@@ -382,7 +416,7 @@ error_code sys_event_port_connect_local(u32 eport_id, u32 equeue_id)
 
 	sys_event.warning("sys_event_port_connect_local(eport_id=0x%x, equeue_id=0x%x)", eport_id, equeue_id);
 
-	std::lock_guard lock(id_manager::g_mutex);
+	std::lock_guard lock(idm::get_mutex<lv2_obj>());
 
 	const auto port = idm::check_unlocked<lv2_obj, lv2_event_port>(eport_id);
 
@@ -414,7 +448,7 @@ error_code sys_event_port_connect_ipc(ppu_thread& ppu, u32 eport_id, u64 ipc_key
 
 	auto queue = lv2_event_queue::find(ipc_key);
 
-	std::lock_guard lock(id_manager::g_mutex);
+	std::lock_guard lock(idm::get_mutex<lv2_obj>());
 
 	const auto port = idm::check_unlocked<lv2_obj, lv2_event_port>(eport_id);
 
@@ -444,7 +478,7 @@ error_code sys_event_port_disconnect(ppu_thread& ppu, u32 eport_id)
 
 	sys_event.warning("sys_event_port_disconnect(eport_id=0x%x)", eport_id);
 
-	std::lock_guard lock(id_manager::g_mutex);
+	std::lock_guard lock(idm::get_mutex<lv2_obj>());
 
 	const auto port = idm::check_unlocked<lv2_obj, lv2_event_port>(eport_id);
 
@@ -2,6 +2,7 @@
 
 #include "sys_sync.h"
 
+#include "Utilities/lockless.h"
 #include "Emu/Memory/vm_ptr.h"
 
 class cpu_thread;
@@ -86,8 +87,9 @@ struct lv2_event_queue final : public lv2_obj
 	const s32 size;
 
 	shared_mutex mutex;
-	std::deque<lv2_event> events;
+	lf_ring<lv2_event> events; // Preallocated, senders push without locking while there are no waiters
 	std::deque<cpu_thread*> sq;
+	atomic_t<u32> waiters{0}; // Receivers in sq, or about to check the events under the mutex
 
 	lv2_event_queue(u32 protocol, s32 type, u64 name, u64 ipc_key, s32 size)
 		: protocol(protocol)
@@ -95,11 +97,29 @@ struct lv2_event_queue final : public lv2_obj
 		, name(name)
 		, key(ipc_key)
 		, size(size)
+		, events(size)
 	{
 	}
 
 	bool send(lv2_event);
 
+	// Try to take an event for the receiver, or register it as a waiter (must be called under the mutex)
+	bool try_receive(lv2_event& event)
+	{
+		waiters++;
+
+		if (events.try_pop(event))
+		{
+			waiters--;
+			return true;
+		}
+
+		return false;
+	}
+
+	// Hand the event over to the first scheduled waiter (must be called under the mutex)
+	void deliver(const lv2_event& event);
+
 	bool send(u64 source, u64 d1, u64 d2, u64 d3)
 	{
 		return send(std::make_tuple(source, d1, d2, d3));
@@ -9,6 +9,7 @@
 #include "Emu/VFS.h"
 #include "Emu/IdManager.h"
 #include "Utilities/StrUtil.h"
+#include "Emu/Memory/vm_locking.h"
 
 LOG_CHANNEL(sys_fs);
 
@@ -63,21 +64,223 @@ lv2_fs_mount_point* lv2_fs_object::get_mp(const char* filename)
 	return &g_mp_sys_dev_hdd0;
 }
 
-u64 lv2_file::op_read(vm::ptr<void> buf, u64 size)
+// Max size of a single native call on guest memory (also the size of the range lock held during the call)
+constexpr u32 c_fs_chunk_size = 0x40000;
+
+// Intermediate buffer size for the fallback path
+constexpr u32 c_fs_copy_size = 0x10000;
+
+// Touch every page of the guest memory range from the current thread, so that access violations
+// (e.g. RSX cache protection) are resolved by the handler instead of failing the native call
+static void fs_touch_pages(u32 addr, u32 size, bool write)
+{
+	for (u32 page = addr & -4096; page < addr + size; page += 4096)
+	{
+		const u32 ptr = std::max(page, addr);
+
+		if (write)
+		{
+			vm::_ref<atomic_t<u8>>(ptr).fetch_add(0);
+		}
+		else
+		{
+			const volatile u8 value = vm::_ref<const volatile u8>(ptr);
+			static_cast<void>(value);
+		}
+	}
+}
+
+// Native file access at the current position (offset = -1) or at the specified offset (without moving the position)
+static u64 fs_native_read(const fs::file& file, u64 offset, void* buf, u64 size)
+{
+	return offset == UINT64_MAX ? file.read(buf, size) : file.read_at(offset, buf, size);
+}
+
+static u64 fs_native_write(const fs::file& file, u64 offset, const void* buf, u64 size)
+{
+	return offset == UINT64_MAX ? file.write(buf, size) : file.write_at(offset, buf, size);
+}
+
+static u64 fs_read_copy(const fs::file& file, u64 offset, u32 addr, u64 size)
 {
 	// Copy data from intermediate buffer (avoid passing vm pointer to a native API)
-	std::unique_ptr<u8[]> local_buf(new u8[size]);
-	const u64 result = file.read(local_buf.get(), size);
-	std::memcpy(buf.get_ptr(), local_buf.get(), result);
+	const std::unique_ptr<u8[]> local_buf(new u8[std::min<u64>(size, c_fs_copy_size)]);
+
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u64 chunk = std::min<u64>(size - result, c_fs_copy_size);
+		const u64 nread = fs_native_read(file, offset == UINT64_MAX ? offset : offset + result, local_buf.get(), chunk);
+		std::memcpy(vm::base(addr + result), local_buf.get(), nread);
+		result += nread;
+
+		if (nread < chunk)
+		{
+			break;
+		}
+	}
+
+	lv2_file::g_bytes_copied += result;
 	return result;
 }
 
-u64 lv2_file::op_write(vm::cptr<void> buf, u64 size)
+static u64 fs_write_copy(const fs::file& file, u64 offset, u32 addr, u64 size)
 {
 	// Copy data to intermediate buffer (avoid passing vm pointer to a native API)
-	std::unique_ptr<u8[]> local_buf(new u8[size]);
-	std::memcpy(local_buf.get(), buf.get_ptr(), size);
-	return file.write(local_buf.get(), size);
+	const std::unique_ptr<u8[]> local_buf(new u8[std::min<u64>(size, c_fs_copy_size)]);
+
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u64 chunk = std::min<u64>(size - result, c_fs_copy_size);
+		std::memcpy(local_buf.get(), vm::base(addr + result), chunk);
+		const u64 nwritten = fs_native_write(file, offset == UINT64_MAX ? offset : offset + result, local_buf.get(), chunk);
+		result += nwritten;
+
+		if (nwritten < chunk)
+		{
+			break;
+		}
+	}
+
+	lv2_file::g_bytes_copied += result;
+	return result;
+}
+
+u64 lv2_file::op_read(vm::ptr<void> buf, u64 size, u64 offset)
+{
+	if (size > UINT32_MAX || !vm::check_addr(buf.addr(), static_cast<u32>(size), vm::page_writable))
+	{
+		return fs_read_copy(file, offset, buf.addr(), size);
+	}
+
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u32 addr = buf.addr() + static_cast<u32>(result);
+		const u32 chunk = static_cast<u32>(std::min<u64>(size - result, c_fs_chunk_size));
+		const u64 pos = offset == UINT64_MAX ? file.pos() : offset + result;
+
+		fs_touch_pages(addr, chunk, true);
+
+		// Pin the range and read directly into guest memory
+		const auto range_lock = vm::passive_lock(addr, addr + chunk);
+
+		u64 nread = 0;
+
+		try
+		{
+			fs::g_tls_error = fs::error::ok;
+			nread = fs_native_read(file, offset == UINT64_MAX ? offset : pos, vm::base(addr), chunk);
+			g_bytes_direct += nread;
+		}
+		catch (const std::runtime_error&)
+		{
+			// Only retry if the range was protected again (e.g. by RSX) before or during the call
+			if (fs::g_tls_error != fs::error::fault)
+			{
+				range_lock->release(0);
+				throw;
+			}
+
+			if (offset == UINT64_MAX)
+			{
+				file.seek(pos);
+			}
+		}
+
+		range_lock->release(0);
+
+		if (nread < chunk)
+		{
+			// Not necessarily EOF: the call stops at the first inaccessible page, so read the rest through the intermediate buffer
+			nread += fs_read_copy(file, offset == UINT64_MAX ? offset : pos + nread, addr + static_cast<u32>(nread), chunk - nread);
+		}
+
+		result += nread;
+
+		if (nread < chunk)
+		{
+			break;
+		}
+	}
+
+	return result;
+}
+
+u64 lv2_file::op_write(vm::cptr<void> buf, u64 size, u64 offset)
+{
+	if (size > UINT32_MAX || !vm::check_addr(buf.addr(), static_cast<u32>(size), vm::page_readable))
+	{
+		return fs_write_copy(file, offset, buf.addr(), size);
+	}
+
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u32 addr = buf.addr() + static_cast<u32>(result);
+		const u32 chunk = static_cast<u32>(std::min<u64>(size - result, c_fs_chunk_size));
+		const u64 pos = offset == UINT64_MAX ? file.pos() : offset + result;
+
+		fs_touch_pages(addr, chunk, false);
+
+		// Pin the range and write directly from guest memory
+		const auto range_lock = vm::passive_lock(addr, addr + chunk);
+
+		u64 nwritten = 0;
+
+		try
+		{
+			fs::g_tls_error = fs::error::ok;
+			nwritten = fs_native_write(file, offset == UINT64_MAX ? offset : pos, vm::base(addr), chunk);
+			g_bytes_direct += nwritten;
+		}
+		catch (const std::runtime_error&)
+		{
+			// Only retry if the range was protected again (e.g. by RSX) before or during the call
+			if (fs::g_tls_error != fs::error::fault)
+			{
+				range_lock->release(0);
+				throw;
+			}
+
+			if (offset == UINT64_MAX)
+			{
+				file.seek(pos);
+			}
+		}
+
+		range_lock->release(0);
+
+		if (nwritten < chunk)
+		{
+			// The call stops at the first inaccessible page, write the rest through the intermediate buffer
+			nwritten += fs_write_copy(file, offset == UINT64_MAX ? offset : pos + nwritten, addr + static_cast<u32>(nwritten), chunk - nwritten);
+		}
+
+		result += nwritten;
+
+		if (nwritten < chunk)
+		{
+			break;
+		}
+	}
+
+	return result;
+}
+
+std::unique_lock<std::mutex> lv2_file::lock_positional_io()
+{
+	if (file.positional_io())
+	{
+		return {};
+	}
+
+	return std::unique_lock(mp->mutex);
 }
 
 struct lv2_file::file_view : fs::file_base
@@ -109,15 +312,37 @@ struct lv2_file::file_view : fs::file_base
 
 	u64 read(void* buffer, u64 size) override
 	{
-		const u64 old_pos = m_file->file.pos();
-		const u64 new_pos = m_file->file.seek(m_off + m_pos);
-		const u64 result = m_file->file.read(buffer, size);
-		verify(HERE), old_pos == m_file->file.seek(old_pos);
+		const u64 result = m_file->file.read_at(m_off + m_pos, buffer, size);
 
 		m_pos += result;
 		return result;
 	}
 
+	u64 read_at(u64 offset, void* buffer, u64 size) override
+	{
+		return m_file->file.read_at(m_off + offset, buffer, size);
+	}
+
+	u64 write_at(u64 offset, const void* buffer, u64 size) override
+	{
+		return 0;
+	}
+
+	bool positional_io() override
+	{
+		return m_file->file.positional_io();
+	}
+
+	fs::file_map map() override
+	{
+		if (auto base = m_file->file.map())
+		{
+			return fs::file_map(base, m_off, UINT64_MAX);
+		}
+
+		return {};
+	}
+
 	u64 write(const void* buffer, u64 size) override
 	{
 		return 0;
@@ -214,6 +439,13 @@ error_code sys_fs_open(ppu_thread& ppu, vm::cptr<char> path, s32 flags, vm::ptr<
 
 	// TODO: other checks for path
 
+	const u64 create_count = fs::get_create_count();
+
+	if (!(flags & CELL_FS_O_CREAT) && vfs::host::is_missing(local_path))
+	{
+		return {CELL_ENOENT, path};
+	}
+
 	if (fs::is_dir(local_path))
 	{
 		return {CELL_EISDIR, path};
@@ -314,7 +546,15 @@ error_code sys_fs_open(ppu_thread& ppu, vm::cptr<char> path, s32 flags, vm::ptr<
 
 		switch (auto error = fs::g_tls_error)
 		{
-		case fs::error::noent: return {CELL_ENOENT, path};
+		case fs::error::noent:
+		{
+			if (open_mode == fs::read)
+			{
+				vfs::host::set_missing(local_path, create_count);
+			}
+
+			return {CELL_ENOENT, path};
+		}
 		default: sys_fs.error("sys_fs_open(): unknown error %s", error);
 		}
 
@@ -636,6 +876,13 @@ error_code sys_fs_stat(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<CellFsStat>
 		return {CELL_ENOTMOUNTED, path};
 	}
 
+	const u64 create_count = fs::get_create_count();
+
+	if (vfs::host::is_missing(local_path))
+	{
+		return {CELL_ENOENT, path};
+	}
+
 	fs::stat_t info{};
 
 	if (!fs::stat(local_path, info))
@@ -669,6 +916,7 @@ error_code sys_fs_stat(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<CellFsStat>
 				break;
 			}
 
+			vfs::host::set_missing(local_path, create_count);
 			return {CELL_ENOENT, path};
 		}
 		default:
@@ -956,14 +1204,9 @@ error_code sys_fs_fcntl(ppu_thread& ppu, u32 fd, u32 op, vm::ptr<void> _arg, u32
 			return CELL_EBUSY;
 		}
 
-		const u64 old_pos = file->file.pos();
-		const u64 new_pos = file->file.seek(arg->offset);
-
 		arg->out_size = op == 0x8000000a
-			? file->op_read(arg->buf, arg->size)
-			: file->op_write(arg->buf, arg->size);
-
-		verify(HERE), old_pos == file->file.seek(old_pos);
+			? file->op_read(arg->buf, arg->size, arg->offset)
+			: file->op_write(arg->buf, arg->size, arg->offset);
 
 		arg->out_code = CELL_OK;
 		return CELL_OK;
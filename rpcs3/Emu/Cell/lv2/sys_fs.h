@@ -4,6 +4,8 @@
 #include "Emu/Cell/ErrorCodes.h"
 #include "Utilities/File.h"
 
+#include <mutex>
+
 // Open Flags
 enum : s32
 {
@@ -187,11 +189,20 @@ struct lv2_file final : lv2_fs_object
 	{
 	}
 
-	// File reading with intermediate buffer
-	u64 op_read(vm::ptr<void> buf, u64 size);
+	// Bytes transferred directly between files and guest memory
+	static inline atomic_t<u64> g_bytes_direct{0};
+
+	// Bytes transferred through intermediate buffer (inaccessible guest memory)
+	static inline atomic_t<u64> g_bytes_copied{0};
+
+	// File reading (directly into guest memory if possible), at the specified offset if not -1
+	u64 op_read(vm::ptr<void> buf, u64 size, u64 offset = -1);
+
+	// File writing (directly from guest memory if possible), at the specified offset if not -1
+	u64 op_write(vm::cptr<void> buf, u64 size, u64 offset = -1);
 
-	// File writing with intermediate buffer
-	u64 op_write(vm::cptr<void> buf, u64 size);
+	// Lock the mount point before positional I/O if the file handle would use the current position (empty lock otherwise)
+	std::unique_lock<std::mutex> lock_positional_io();
 
 	// For MSELF support
 	struct file_view;
@@ -80,6 +80,9 @@ error_code _sys_interrupt_thread_establish(ppu_thread& ppu, vm::ptr<u32> ih, u32
 
 	CellError error = CELL_EAGAIN;
 
+	// Get interrupt thread (before locking the lv2 table, ID tables are not locked in nested fashion)
+	const auto it = idm::get<named_thread<ppu_thread>>(intrthread);
+
 	const u32 id = idm::import<lv2_obj, lv2_int_serv>([&]()
 	{
 		std::shared_ptr<lv2_int_serv> result;
@@ -93,9 +96,6 @@ error_code _sys_interrupt_thread_establish(ppu_thread& ppu, vm::ptr<u32> ih, u32
 			return result;
 		}
 
-		// Get interrupt thread
-		const auto it = idm::get_unlocked<named_thread<ppu_thread>>(intrthread);
-
 		if (!it)
 		{
 			error = CELL_ESRCH;
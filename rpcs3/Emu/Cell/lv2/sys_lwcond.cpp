@@ -86,9 +86,12 @@ error_code _sys_lwcond_signal(ppu_thread& ppu, u32 lwcond_id, u32 lwmutex_id, u3
 		fmt::throw_exception("Unknown mode (%d)" HERE, mode);
 	}
 
+	// Check the thread before locking the lv2 table (ID tables are not locked in nested fashion)
+	const bool thread_exists = ppu_thread_id == -1 || idm::check<named_thread<ppu_thread>>(ppu_thread_id) != nullptr;
+
 	const auto cond = idm::check<lv2_obj, lv2_lwcond>(lwcond_id, [&](lv2_lwcond& cond) -> cpu_thread*
 	{
-		if (ppu_thread_id != -1 && !idm::check_unlocked<named_thread<ppu_thread>>(ppu_thread_id))
+		if (!thread_exists)
 		{
 			return (cpu_thread*)(1);
 		}
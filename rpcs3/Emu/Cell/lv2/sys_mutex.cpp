@@ -114,8 +114,41 @@ error_code sys_mutex_lock(ppu_thread& ppu, u32 mutex_id, u64 timeout)
 
 	sys_mutex.trace("sys_mutex_lock(mutex_id=0x%x, timeout=0x%llx)", mutex_id, timeout);
 
+	// Fast path: uncontended CAS on the owner word, no refcounting and no object mutex
+	const auto fast = idm::check<lv2_obj, lv2_mutex>(mutex_id, [&](lv2_mutex& mutex)
+	{
+		const CellError result = mutex.try_lock(ppu.id);
+
+		if (!result && g_cfg.core.sync_stats)
+		{
+			mutex.stats.fast++;
+		}
+
+		return result;
+	});
+
+	if (!fast)
+	{
+		return CELL_ESRCH;
+	}
+
+	if (fast.ret != CELL_EBUSY)
+	{
+		if (fast.ret)
+		{
+			return fast.ret;
+		}
+
+		return CELL_OK;
+	}
+
 	const auto mutex = idm::get<lv2_obj, lv2_mutex>(mutex_id, [&](lv2_mutex& mutex)
 	{
+		if (g_cfg.core.sync_stats)
+		{
+			mutex.stats.contended++;
+		}
+
 		CellError result = mutex.try_lock(ppu.id);
 
 		if (result == CELL_EBUSY)
@@ -128,6 +161,11 @@ error_code sys_mutex_lock(ppu_thread& ppu, u32 mutex_id, u64 timeout)
 			}
 			else
 			{
+				if (g_cfg.core.sync_stats)
+				{
+					mutex.stats.slept++;
+				}
+
 				mutex.sleep(ppu, timeout);
 			}
 		}
@@ -194,7 +232,14 @@ error_code sys_mutex_trylock(ppu_thread& ppu, u32 mutex_id)
 
 	const auto mutex = idm::check<lv2_obj, lv2_mutex>(mutex_id, [&](lv2_mutex& mutex)
 	{
-		return mutex.try_lock(ppu.id);
+		const CellError result = mutex.try_lock(ppu.id);
+
+		if (!result && g_cfg.core.sync_stats)
+		{
+			mutex.stats.fast++;
+		}
+
+		return result;
 	});
 
 	if (!mutex)
@@ -1481,7 +1481,7 @@ s32 sys_net_bnet_poll(ppu_thread& ppu, vm::ptr<sys_net_pollfd> fds, s32 nfds, s3
 	{
 		std::lock_guard nw_lock(s_nw_mutex);
 
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(idm::get_mutex<lv2_socket>().reader());
 
 #ifndef _WIN32
 		::pollfd _fds[1024]{};
@@ -1656,7 +1656,7 @@ s32 sys_net_bnet_select(ppu_thread& ppu, s32 nfds, vm::ptr<sys_net_fd_set> readf
 	{
 		std::lock_guard nw_lock(s_nw_mutex);
 
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(idm::get_mutex<lv2_socket>().reader());
 
 #ifndef _WIN32
 		::pollfd _fds[1024]{};
@@ -43,7 +43,7 @@ void _sys_ppu_thread_exit(ppu_thread& ppu, u64 errorcode)
 	}
 	else if (jid != 0)
 	{
-		std::lock_guard lock(id_manager::g_mutex);
+		std::lock_guard lock(idm::get_mutex<named_thread<ppu_thread>>());
 
 		// Schedule joiner and unqueue
 		lv2_obj::awake(*idm::check_unlocked<named_thread<ppu_thread>>(jid), -2);
@@ -87,22 +87,48 @@ error_code sys_semaphore_wait(ppu_thread& ppu, u32 sem_id, u64 timeout)
 
 	sys_semaphore.trace("sys_semaphore_wait(sem_id=0x%x, timeout=0x%llx)", sem_id, timeout);
 
-	const auto sem = idm::get<lv2_obj, lv2_sema>(sem_id, [&](lv2_sema& sema)
+	// Fast path: decrement positive counter without refcounting the object
+	const auto fast = idm::check<lv2_obj, lv2_sema>(sem_id, [&](lv2_sema& sema)
 	{
-		const s32 val = sema.val;
-
-		if (val > 0)
+		if (sema.val.try_dec(0))
 		{
-			if (sema.val.compare_and_swap_test(val, val - 1))
+			if (g_cfg.core.sync_stats)
 			{
-				return true;
+				sema.stats.fast++;
 			}
+
+			return true;
+		}
+
+		return false;
+	});
+
+	if (!fast)
+	{
+		return CELL_ESRCH;
+	}
+
+	if (fast.ret)
+	{
+		return CELL_OK;
+	}
+
+	const auto sem = idm::get<lv2_obj, lv2_sema>(sem_id, [&](lv2_sema& sema)
+	{
+		if (g_cfg.core.sync_stats)
+		{
+			sema.stats.contended++;
 		}
 
 		std::lock_guard lock(sema.mutex);
 
 		if (sema.val-- <= 0)
 		{
+			if (g_cfg.core.sync_stats)
+			{
+				sema.stats.slept++;
+			}
+
 			sema.sq.emplace_back(&ppu);
 			sema.sleep(ppu, timeout);
 			return false;
@@ -171,7 +197,17 @@ error_code sys_semaphore_trywait(ppu_thread& ppu, u32 sem_id)
 
 	const auto sem = idm::check<lv2_obj, lv2_sema>(sem_id, [&](lv2_sema& sema)
 	{
-		return sema.val.try_dec(0);
+		if (sema.val.try_dec(0))
+		{
+			if (g_cfg.core.sync_stats)
+			{
+				sema.stats.fast++;
+			}
+
+			return true;
+		}
+
+		return false;
 	});
 
 	if (!sem)
@@ -193,13 +229,14 @@ error_code sys_semaphore_post(ppu_thread& ppu, u32 sem_id, s32 count)
 
 	sys_semaphore.trace("sys_semaphore_post(sem_id=0x%x, count=%d)", sem_id, count);
 
-	const auto sem = idm::get<lv2_obj, lv2_sema>(sem_id, [&](lv2_sema& sema)
+	// Fast path: no waiters, increment the counter without refcounting the object
+	const auto fast = idm::check<lv2_obj, lv2_sema>(sem_id, [&](lv2_sema& sema)
 	{
-		const s32 val = sema.val;
+		s32 val = sema.val;
 
-		if (val >= 0 && count > 0 && count <= sema.max - val)
+		while (val >= 0 && count > 0 && count <= sema.max - val)
 		{
-			if (sema.val.compare_and_swap_test(val, val + count))
+			if (sema.val.compare_exchange(val, val + count))
 			{
 				return true;
 			}
@@ -208,7 +245,7 @@ error_code sys_semaphore_post(ppu_thread& ppu, u32 sem_id, s32 count)
 		return false;
 	});
 
-	if (!sem)
+	if (!fast)
 	{
 		return CELL_ESRCH;
 	}
@@ -218,32 +255,37 @@ error_code sys_semaphore_post(ppu_thread& ppu, u32 sem_id, s32 count)
 		return CELL_EINVAL;
 	}
 
-	if (sem.ret)
+	if (fast.ret)
 	{
 		return CELL_OK;
 	}
-	else
+
+	const auto sem = idm::get<lv2_obj, lv2_sema>(sem_id);
+
+	if (!sem)
 	{
-		std::lock_guard lock(sem->mutex);
+		return CELL_ESRCH;
+	}
 
-		const s32 val = sem->val.fetch_op([=](s32& val)
-		{
-			if (val + s64{count} <= sem->max)
-			{
-				val += count;
-			}
-		});
+	std::lock_guard lock(sem->mutex);
 
-		if (val + s64{count} > sem->max)
+	const s32 val = sem->val.fetch_op([=](s32& val)
+	{
+		if (val + s64{count} <= sem->max)
 		{
-			return not_an_error(CELL_EBUSY);
+			val += count;
 		}
+	});
 
-		// Wake threads
-		for (s32 i = std::min<s32>(-std::min<s32>(val, 0), count); i > 0; i--)
-		{
-			sem->awake(*verify(HERE, sem->schedule<ppu_thread>(sem->sq, sem->protocol)));
-		}
+	if (val + s64{count} > sem->max)
+	{
+		return not_an_error(CELL_EBUSY);
+	}
+
+	// Wake threads
+	for (s32 i = std::min<s32>(-std::min<s32>(val, 0), count); i > 0; i--)
+	{
+		sem->awake(*verify(HERE, sem->schedule<ppu_thread>(sem->sq, sem->protocol)));
 	}
 
 	return CELL_OK;
@@ -33,6 +33,7 @@ struct lv2_sema final : lv2_obj
 	shared_mutex mutex;
 	atomic_t<s32> val;
 	std::deque<cpu_thread*> sq;
+	lv2_sync_stats stats;
 
 	lv2_sema(u32 protocol, u32 shared, u64 key, s32 flags, u64 name, s32 max, s32 value)
 		: protocol(protocol)
@@ -1481,12 +1481,13 @@ error_code sys_raw_spu_create_interrupt_tag(ppu_thread& ppu, u32 id, u32 class_i
 
 	CellError error = {};
 
+	// Get the thread before locking the lv2 table (ID tables are not locked in nested fashion)
+	const auto thread = idm::get<named_thread<spu_thread>>(spu_thread::find_raw_spu(id));
+
 	const auto tag = idm::import<lv2_obj, lv2_int_tag>([&]()
 	{
 		std::shared_ptr<lv2_int_tag> result;
 
-		auto thread = idm::check_unlocked<named_thread<spu_thread>>(spu_thread::find_raw_spu(id));
-
 		if (!thread || thread->group)
 		{
 			error = CELL_ESRCH;
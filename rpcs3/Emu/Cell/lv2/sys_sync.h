@@ -57,6 +57,15 @@ enum
 	SYS_SYNC_ATTR_ADAPTIVE_MASK  = 0xf000,
 };
 
+// Contention statistics of a synchronization object (displayed in kernel explorer)
+// Only updated if enabled in config, because counting dirties the object on the fast path
+struct lv2_sync_stats
+{
+	atomic_t<u64> fast{0}; // Acquired without touching the sleep queue
+	atomic_t<u64> contended{0}; // Fell back to the slow path
+	atomic_t<u64> slept{0}; // Had to sleep in the slow path
+};
+
 // Base class for some kernel objects (shared set of 8192 objects).
 struct lv2_obj
 {
@@ -9,9 +9,65 @@
 // Helper namespace
 namespace id_manager
 {
-	// Common global mutex
+	// Global mutex (fxm objects)
 	extern shared_mutex g_mutex;
 
+	// Lock of an ID table. Readers only lock the shard assigned to the current thread,
+	// so concurrent lookups don't write to a shared cache line; writers lock all shards.
+	class table_lock
+	{
+		static constexpr u32 c_shards = 16;
+
+		struct alignas(64) shard
+		{
+			shared_mutex mutex;
+		};
+
+		shard m_shards[c_shards]{};
+
+		static u32 get_shard()
+		{
+			static atomic_t<u32> g_next{0};
+
+			thread_local const u32 index = g_next++ % c_shards;
+
+			return index;
+		}
+
+	public:
+		// Get the mutex to use with reader_lock (must not be upgraded)
+		shared_mutex& reader()
+		{
+			return m_shards[get_shard()].mutex;
+		}
+
+		void lock()
+		{
+			for (auto& s : m_shards)
+			{
+				s.mutex.lock();
+			}
+		}
+
+		void unlock()
+		{
+			for (u32 i = c_shards; i--;)
+			{
+				m_shards[i].mutex.unlock();
+			}
+		}
+	};
+
+	// Lock of the ID table of the base type T, kept separate for each type so that lookups
+	// of one type never contend with creation/destruction of objects of unrelated types.
+	// Lock order: a table may not be locked while holding the lock of a different table,
+	// so callbacks and providers must not look up objects of another base type.
+	template <typename T>
+	struct id_lock
+	{
+		static inline table_lock g_mutex{};
+	};
+
 	// ID traits
 	template <typename T, typename = void>
 	struct id_traits
@@ -268,7 +324,7 @@ class idm
 		using traits = id_manager::id_traits<Type>;
 
 		// Allocate new id
-		std::lock_guard lock(id_manager::g_mutex);
+		std::lock_guard lock(get_mutex<T>());
 
 		if (auto* place = allocate_id(info, traits::base, traits::step, traits::count))
 		{
@@ -285,6 +341,13 @@ class idm
 	}
 
 public:
+	// Get the lock protecting the ID table of the specified base type
+	template <typename T>
+	static inline id_manager::table_lock& get_mutex()
+	{
+		return id_manager::id_lock<T>::g_mutex;
+	}
+
 	// Initialize object manager
 	static void init();
 
@@ -368,7 +431,7 @@ public:
 	template <typename T, typename Get = T>
 	static inline Get* check(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_mutex<T>().reader());
 
 		return check_unlocked<T, Get>(id);
 	}
@@ -377,7 +440,7 @@ public:
 	template <typename T, typename Get = T, typename F, typename FRT = std::invoke_result_t<F, Get&>>
 	static inline auto check(u32 id, F&& func)
 	{
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_mutex<T>().reader());
 
 		if (const auto ptr = check_unlocked<T, Get>(id))
 		{
@@ -420,7 +483,7 @@ public:
 	template <typename T, typename Get = T>
 	static inline std::shared_ptr<Get> get(u32 id)
 	{
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_mutex<T>().reader());
 
 		const auto found = find_id<T, Get>(id);
 
@@ -436,7 +499,7 @@ public:
 	template <typename T, typename Get = T, typename F, typename FRT = std::invoke_result_t<F, Get&>>
 	static inline std::conditional_t<std::is_void_v<FRT>, std::shared_ptr<Get>, return_pair<Get, FRT>> get(u32 id, F&& func)
 	{
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_mutex<T>().reader());
 
 		const auto found = find_id<T, Get>(id);
 
@@ -464,7 +527,7 @@ public:
 	{
 		static_assert(id_manager::id_verify<T, Get>::value, "Invalid ID type combination");
 
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_mutex<T>().reader());
 
 		u32 result = 0;
 
@@ -492,7 +555,7 @@ public:
 		using object_type = typename function_traits<FT>::object_type;
 		using result_type = return_pair<object_type, FRT>;
 
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_mutex<T>().reader());
 
 		for (auto& id : g_map[get_type<T>()])
 		{
@@ -517,7 +580,7 @@ public:
 	{
 		std::shared_ptr<void> ptr;
 		{
-			std::lock_guard lock(id_manager::g_mutex);
+			std::lock_guard lock(get_mutex<T>());
 
 			if (const auto found = find_id<T, Get>(id))
 			{
@@ -538,7 +601,7 @@ public:
 	{
 		std::shared_ptr<void> ptr;
 		{
-			std::lock_guard lock(id_manager::g_mutex);
+			std::lock_guard lock(get_mutex<T>());
 
 			if (const auto found = find_id<T, Get>(id))
 			{
@@ -557,7 +620,7 @@ public:
 	template <typename T, typename Get = T, typename F, typename FRT = std::invoke_result_t<F, Get&>>
 	static inline std::conditional_t<std::is_void_v<FRT>, std::shared_ptr<Get>, return_pair<Get, FRT>> withdraw(u32 id, F&& func)
 	{
-		std::unique_lock lock(id_manager::g_mutex);
+		std::unique_lock lock(get_mutex<T>());
 
 		if (const auto found = find_id<T, Get>(id))
 		{
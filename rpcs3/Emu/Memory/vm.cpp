@@ -11,6 +11,7 @@
 #include "Utilities/VirtualMemory.h"
 #include "Utilities/asm.h"
 #include "Emu/CPU/CPUThread.h"
+#include "Emu/CPU/CPUTimeStats.h"
 #include "Emu/Cell/lv2/sys_memory.h"
 #include "Emu/RSX/GSRender.h"
 #include <atomic>
@@ -115,6 +116,7 @@ namespace vm
 			passive_unlock(cpu);
 		}
 
+		cpu_activity_scope scope(cpu_activity::passive_lock);
 		::reader_lock lock(g_mutex);
 		_register_lock(&cpu);
 	}
@@ -142,6 +144,7 @@ namespace vm
 		}
 
 		{
+			cpu_activity_scope scope(cpu_activity::passive_lock);
 			::reader_lock lock(g_mutex);
 			_ret = _register_range_lock((u64)end << 32 | addr);
 		}
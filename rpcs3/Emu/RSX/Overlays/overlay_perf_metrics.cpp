@@ -5,6 +5,8 @@
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/RawSPUThread.h"
 #include "Emu/Cell/PPUThread.h"
+#include "Emu/CPU/CPUTimeStats.h"
+#include "Emu/Audio/AudioRing.h"
 #include "Utilities/sysinfo.h"
 
 namespace rsx
@@ -117,6 +119,19 @@ namespace rsx
 			case detail_level::medium: m_titles.text = fmt::format("\n\n%s", title1_medium); break;
 			case detail_level::high: m_titles.text = fmt::format("\n\n%s\n\n\n\n\n\n%s", title1_high, title2); break;
 			}
+
+			if (m_detail == detail_level::high && g_cfg.core.cpu_time_accounting)
+			{
+				m_titles.text += fmt::format("\n\n\n%s", title3);
+			}
+
+			m_audio_shown = m_detail == detail_level::high && g_audio_ring_stats.active;
+
+			if (m_audio_shown)
+			{
+				m_titles.text += fmt::format(g_cfg.core.cpu_time_accounting ? "\n\n\n\n%s" : "\n\n\n%s", title4);
+			}
+
 			m_titles.auto_resize();
 			m_titles.refresh();
 		}
@@ -338,12 +353,79 @@ namespace rsx
 					                         "%s\n"
 					                         " RSX   : %02u %%",
 					    fps, frametime, std::string(title1_high.size(), ' '), ppu_usage, ppus, spu_usage, spus, rsx_usage, cpu_usage, total_threads, std::string(title2.size(), ' '), rsx_load);
+
+					if (g_cfg.core.cpu_time_accounting)
+					{
+						// Share of the sampled thread time in the last window
+						const auto format_time = [](u32 type)
+						{
+							static const char* const names[] = {"run", "lv2", "chn", "rsv", "lck", "jit", "flt"};
+							static_assert(std::size(names) == cpu_time_stats::count);
+
+							const auto time = cpu_time_stats::get_recent(type);
+
+							u64 total = 0;
+
+							for (u64 t : time)
+							{
+								total += t;
+							}
+
+							std::string result;
+
+							for (u32 i = 0; i < time.size(); i++)
+							{
+								fmt::append(result, " %s %02.0f", names[i], total ? time[i] * 100. / total : 0.);
+							}
+
+							return result;
+						};
+
+						perf_text += fmt::format("\n\n"
+						                         "%s\n"
+						                         " PPU  :%s\n"
+						                         " SPU  :%s",
+						    std::string(title3.size(), ' '), format_time(1), format_time(2));
+					}
+
+					if (g_audio_ring_stats.active)
+					{
+						const auto& stats = g_audio_ring_stats;
+
+						u64 fill_total = 0;
+
+						for (const auto& v : stats.fill)
+						{
+							fill_total += v;
+						}
+
+						std::string fill;
+
+						for (const auto& v : stats.fill)
+						{
+							fmt::append(fill, " %02.0f", fill_total ? v * 100. / fill_total : 0.);
+						}
+
+						perf_text += fmt::format("\n\n"
+						                         "%s\n"
+						                         " Latency  : %5.1fms (max %5.1fms)\n"
+						                         " Underrun : %u\n"
+						                         " Fill %%   :%s",
+						    std::string(title4.size(), ' '), stats.latency / 1000., stats.latency_max / 1000., stats.underruns.load(), fill);
+					}
+
 					break;
 				}
 				}
 
 				m_body.text = perf_text;
 
+				if (m_audio_shown != (m_detail == detail_level::high && g_audio_ring_stats.active))
+				{
+					// Audio output was opened or closed
+					reset_titles();
+				}
+
 				if (m_body.auto_resize())
 				{
 					reset_transforms();
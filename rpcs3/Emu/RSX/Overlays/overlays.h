@@ -330,7 +330,7 @@ namespace rsx
 			   minimal - fps
 			   low - fps, total cpu usage
 			   medium - fps, detailed cpu usage
-			   high - fps, frametime, detailed cpu usage, thread number, rsx load
+			   high - fps, frametime, detailed cpu usage, thread number, rsx load, guest thread time breakdown (if enabled), audio output (if available)
 			 */
 			detail_level m_detail;
 
@@ -352,10 +352,13 @@ namespace rsx
 
 			bool m_force_update;
 			bool m_is_initialised{ false };
+			bool m_audio_shown{ false };
 
 			const std::string title1_medium{"CPU Utilization:"};
 			const std::string title1_high{"Host Utilization (CPU):"};
 			const std::string title2{"Guest Utilization (PS3):"};
+			const std::string title3{"Guest Thread Time:"};
+			const std::string title4{"Audio Output:"};
 
 			void reset_transform(label& elm) const;
 			void reset_transforms();
@@ -8,6 +8,8 @@
 #include "Emu/Cell/PPUOpcodes.h"
 #include "Emu/Cell/PPUDisAsm.h"
 #include "Emu/Cell/PPUAnalyser.h"
+#include "Emu/Cell/PPUProfiler.h"
+#include "Emu/CPU/CPUTimeStats.h"
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/RawSPUThread.h"
 #include "Emu/Cell/lv2/sys_memory.h"
@@ -987,6 +989,8 @@ void Emulator::Load(const std::string& title_id, bool add_only, bool force_globa
 
 		LOG_NOTICE(LOADER, "Used configuration:\n%s\n", g_cfg.to_string());
 
+		logs::set_deferred(g_cfg.misc.deferred_log);
+
 		// Set RTM usage
 		g_use_rtm = utils::has_rtm() && ((utils::has_mpx() && g_cfg.core.enable_TSX == tsx_usage::enabled) || g_cfg.core.enable_TSX == tsx_usage::forced);
 
@@ -1590,6 +1594,8 @@ void Emulator::Run()
 	idm::select<named_thread<ppu_thread>>(on_select);
 	idm::select<named_thread<spu_thread>>(on_select);
 
+	cpu_time_stats::start();
+
 #ifdef WITH_GDB_DEBUGGER
 	// Initialize debug server at the end of emu run sequence
 	fxm::make<GDBDebugServer>();
@@ -1731,6 +1737,11 @@ void Emulator::Stop(bool restart)
 
 	LOG_NOTICE(GENERAL, "All threads stopped...");
 
+	ppu_profiler::dump();
+	cpu_time_stats::stop();
+	cpu_time_stats::dump();
+	cpu_time_stats::clear();
+
 	lv2_obj::cleanup();
 	idm::clear();
 	fxm::clear();
@@ -391,22 +391,30 @@ struct cfg_root : cfg::node
 		cfg::_int<1, 4> ppu_threads{this, "PPU Threads", 2}; // Amount of PPU threads running simultaneously (must be 2)
 		cfg::_bool ppu_debug{this, "PPU Debug"};
 		cfg::_bool llvm_logs{this, "Save LLVM logs"};
+		cfg::_bool ppu_call_profiler{this, "PPU Call Profiler", false}; // Collect per-syscall and per-HLE function timings
+		cfg::_bool cpu_time_accounting{this, "CPU Time Accounting", false}; // Sample host time breakdown of PPU/SPU threads
+		cfg::_bool sync_stats{this, "Sync Object Statistics", false}; // Count lv2 mutex/semaphore contention (shown in kernel explorer)
 		cfg::string llvm_cpu{this, "Use LLVM CPU"};
 		cfg::_int<0, INT32_MAX> llvm_threads{this, "Max LLVM Compile Threads", 0};
 		cfg::_bool thread_scheduler_enabled{this, "Enable thread scheduler", thread_scheduler_enabled_def};
+		cfg::string ppu_affinity{this, "PPU Affinity Mask"}; // Hexadecimal, overrides the mask derived from CPU topology
+		cfg::string spu_affinity{this, "SPU Affinity Mask"};
+		cfg::string rsx_affinity{this, "RSX Affinity Mask"};
 		cfg::_bool set_daz_and_ftz{this, "Set DAZ and FTZ", false};
 		cfg::_enum<spu_decoder_type> spu_decoder{this, "SPU Decoder", spu_decoder_type::llvm};
 		cfg::_bool lower_spu_priority{this, "Lower SPU thread priority"};
 		cfg::_bool spu_debug{this, "SPU Debug"};
-		cfg::_int<0, 6> preferred_spu_threads{this, "Preferred SPU Threads", 0}; //Numnber of hardware threads dedicated to heavy simultaneous spu tasks
-		cfg::_int<0, 16> spu_delay_penalty{this, "SPU delay penalty", 3}; //Number of milliseconds to block a thread if a virtual 'core' isn't free
+		cfg::_int<0, 6> preferred_spu_threads{this, "Preferred SPU Threads", 0}; //Number of SPU threads allowed to execute simultaneously (0 = auto: host threads minus two, at least two)
+		cfg::_int<0, 16> spu_delay_penalty{this, "SPU delay penalty", 3}; //SPU execution slot time slice (ms) when other threads are waiting
 		cfg::_bool spu_loop_detection{this, "SPU loop detection", true}; //Try to detect wait loops and trigger thread yield
 		cfg::_int<0, 6> max_spurs_threads{this, "Max SPURS Threads", 6}; // HACK. If less then 6, max number of running SPURS threads in each thread group.
+		cfg::_bool spu_reservation_backoff{this, "SPU Reservation Wait Backoff", false}; // Poll lost reservation less often while waiting (relies on writers waking the waiters)
 		cfg::_enum<spu_block_size_type> spu_block_size{this, "SPU Block Size", spu_block_size_type::safe};
 		cfg::_bool spu_accurate_getllar{this, "Accurate GETLLAR", false};
 		cfg::_bool spu_accurate_putlluc{this, "Accurate PUTLLUC", false};
 		cfg::_bool spu_verification{this, "SPU Verification", true}; // Should be enabled
 		cfg::_bool spu_cache{this, "SPU Cache", true};
+		cfg::_bool self_cache{this, "Decrypted SELF Cache", true}; // Keep decrypted executables in the PPU cache directory
 		cfg::_enum<tsx_usage> enable_TSX{this, "Enable TSX", tsx_usage::enabled}; // Enable TSX. Forcing this on Haswell/Broadwell CPUs should be used carefully
 		cfg::_bool spu_accurate_xfloat{this, "Accurate xfloat", false};
 		cfg::_bool spu_approx_xfloat{this, "Approximate xfloat", true};
@@ -416,6 +424,8 @@ struct cfg_root : cfg::node
 		cfg::_bool hook_functions{this, "Hook static functions"};
 		cfg::set_entry load_libraries{this, "Load libraries"};
 		cfg::_bool hle_lwmutex{this, "HLE lwmutex"}; // Force alternative lwmutex/lwcond implementation
+		cfg::_int<0, 16> vdec_threads{this, "Video Decoder Threads", 0}; // FFmpeg threads per cellVdec decoder (0: automatic)
+		cfg::_bool vdec_frame_threading{this, "Video Decoder Frame Threading", false}; // Decode several pictures in parallel (adds a few frames of delay)
 
 		cfg::_int<10, 1000> clocks_scale{this, "Clocks scale", 100}; // Changing this from 100 (percentage) may affect game speed in unexpected ways
 		cfg::_enum<sleep_timers_accuracy_level> sleep_timers_accuracy{this, "Sleep timers accuracy", sleep_timers_accuracy_level::_as_host}; // Affects sleep timers accuracy (to fix host's sleep accuracy)
@@ -560,6 +570,8 @@ struct cfg_root : cfg::node
 		cfg::_enum<audio_renderer> renderer{this, "Renderer", static_cast<audio_renderer>(1)};
 
 		cfg::_bool dump_to_file{this, "Dump to file"};
+		cfg::_bool dump_compressed{this, "Dump Compressed (FLAC)", false};
+		cfg::_int<0, 4096> dump_rotation_size{this, "Dump Rotation Size (MB)", 0}; // Start a new file after this size, 0 to disable
 		cfg::_bool convert_to_u16{this, "Convert to 16 bit"};
 		cfg::_bool downmix_to_2ch{this, "Downmix to Stereo", true};
 		cfg::_int<1, 128> startt{this, "Start Threshold", 1}; // TODO: used only by ALSA, should probably be removed once ALSA is upgraded
@@ -615,6 +627,7 @@ struct cfg_root : cfg::node
 		cfg::_bool show_shader_compilation_hint{ this, "Show shader compilation hint", true };
 		cfg::_bool use_native_interface{ this, "Use native user interface", true };
 		cfg::_int<1, 65535> gdb_server_port{this, "Port", 2345};
+		cfg::_bool deferred_log{this, "Deferred log formatting", false}; // Format log messages in the background thread
 
 	} misc{this};
 
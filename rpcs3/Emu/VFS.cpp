@@ -21,6 +21,20 @@ struct vfs_manager
 
 	// VFS root
 	vfs_directory root;
+
+	// Max number of entries in each cache (cleared when full)
+	static constexpr std::size_t cache_max = 4096;
+
+	// Negative lookups expire after this time (usec) to tolerate changes done outside of the emulator
+	static constexpr u64 missing_ttl = 1'000'000;
+
+	shared_mutex cache_mutex;
+
+	// Resolved paths: guest path -> host path (cleared on mount)
+	std::unordered_map<std::string, std::string> cache;
+
+	// Host paths reported as nonexistent -> time of the lookup and fs::get_create_count() before it
+	std::unordered_map<std::string, std::pair<u64, u64>> missing;
 };
 
 bool vfs::mount(std::string_view vpath, std::string_view path)
@@ -50,6 +64,10 @@ bool vfs::mount(std::string_view vpath, std::string_view path)
 		{
 			// Mounting completed
 			list.back()->path = path;
+
+			std::lock_guard cache_lock(table->cache_mutex);
+			table->cache.clear();
+			table->missing.clear();
 			return true;
 		}
 
@@ -96,12 +114,8 @@ bool vfs::mount(std::string_view vpath, std::string_view path)
 	}
 }
 
-std::string vfs::get(std::string_view vpath, std::vector<std::string>* out_dir)
+static std::string vfs_get_impl(const vfs_manager* table, std::string_view vpath, std::vector<std::string>* out_dir)
 {
-	const auto table = fxm::get_always<vfs_manager>();
-
-	reader_lock lock(table->mutex);
-
 	// Resulting path fragments: decoded ones
 	std::vector<std::string_view> result;
 	result.reserve(vpath.size() / 2);
@@ -231,6 +245,41 @@ std::string vfs::get(std::string_view vpath, std::vector<std::string>* out_dir)
 	return std::string{result_base} + vfs::escape(fmt::merge(result, "/"));
 }
 
+std::string vfs::get(std::string_view vpath, std::vector<std::string>* out_dir)
+{
+	const auto table = fxm::get_always<vfs_manager>();
+
+	if (out_dir)
+	{
+		reader_lock lock(table->mutex);
+
+		return vfs_get_impl(table.get(), vpath, out_dir);
+	}
+
+	{
+		reader_lock lock(table->cache_mutex);
+
+		if (const auto found = table->cache.find(std::string{vpath}); found != table->cache.end())
+		{
+			return found->second;
+		}
+	}
+
+	reader_lock lock(table->mutex);
+
+	std::string result = vfs_get_impl(table.get(), vpath, nullptr);
+
+	std::lock_guard cache_lock(table->cache_mutex);
+
+	if (table->cache.size() >= vfs_manager::cache_max)
+	{
+		table->cache.clear();
+	}
+
+	table->cache.emplace(vpath, result);
+	return result;
+}
+
 std::string vfs::escape(std::string_view path)
 {
 	std::string result;
@@ -460,6 +509,35 @@ std::string vfs::unescape(std::string_view path)
 	return result;
 }
 
+bool vfs::host::is_missing(const std::string& path)
+{
+	const auto table = fxm::get_always<vfs_manager>();
+
+	reader_lock lock(table->cache_mutex);
+
+	if (const auto found = table->missing.find(path); found != table->missing.end())
+	{
+		// Anything created through fs:: since the lookup invalidates it
+		return found->second.second == fs::get_create_count() && get_system_time() - found->second.first < vfs_manager::missing_ttl;
+	}
+
+	return false;
+}
+
+void vfs::host::set_missing(const std::string& path, u64 create_count)
+{
+	const auto table = fxm::get_always<vfs_manager>();
+
+	std::lock_guard lock(table->cache_mutex);
+
+	if (table->missing.size() >= vfs_manager::cache_max)
+	{
+		table->missing.clear();
+	}
+
+	table->missing.insert_or_assign(path, std::make_pair(get_system_time(), create_count));
+}
+
 bool vfs::host::rename(const std::string& from, const std::string& to, bool overwrite)
 {
 	while (!fs::rename(from, to, overwrite))
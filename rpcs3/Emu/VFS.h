@@ -21,6 +21,12 @@ namespace vfs
 	// Functions in this namespace operate on host filepaths, similar to fs::
 	namespace host
 	{
+		// Check whether the path was recently reported nonexistent (negative lookup cache)
+		bool is_missing(const std::string& path);
+
+		// Remember that the path doesn't exist (create_count: fs::get_create_count() obtained before the lookup)
+		void set_missing(const std::string& path, u64 create_count);
+
 		// Call fs::rename with retry on access error
 		bool rename(const std::string& from, const std::string& to, bool overwrite);
 
@@ -4,6 +4,7 @@
 #include "Utilities/Timer.h"
 #include "Utilities/date_time.h"
 #include "Emu/System.h"
+#include "Emu/Cell/PPUProfiler.h"
 
 #include <QKeyEvent>
 #include <QTimer>
@@ -140,6 +141,7 @@ void gs_frame::keyPressEvent(QKeyEvent *keyEvent)
 		break;
 	case Qt::Key_P:
 		if (keyEvent->modifiers() == Qt::ControlModifier && Emu.IsRunning()) { Emu.Pause(); return; }
+		if (keyEvent->modifiers() == Qt::AltModifier && !Emu.IsStopped()) { ppu_profiler::dump(); return; }
 		break;
 	case Qt::Key_S:
 		if (keyEvent->modifiers() == Qt::ControlModifier && (!Emu.IsStopped())) { Emu.Stop(); return; }
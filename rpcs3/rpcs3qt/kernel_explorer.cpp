@@ -4,6 +4,7 @@
 
 #include "Emu/IdManager.h"
 #include "Emu/Cell/PPUThread.h"
+#include "Emu/Cell/PPUProfiler.h"
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/RawSPUThread.h"
 #include "Emu/Cell/lv2/sys_lwmutex.h"
@@ -150,8 +151,9 @@ void kernel_explorer::Update()
 		case SYS_MUTEX_OBJECT:
 		{
 			auto& mutex = static_cast<lv2_mutex&>(obj);
-			l_addTreeChild(node, qstr(fmt::format("Mutex: ID = 0x%08x \"%s\",%s Owner = 0x%x, Locks = %u, Conds = %u, Wq = %zu", id, +name64(mutex.name),
-				mutex.recursive == SYS_SYNC_RECURSIVE ? " Recursive," : "", mutex.owner >> 1, +mutex.lock_count, +mutex.cond_count, mutex.sq.size())));
+			l_addTreeChild(node, qstr(fmt::format("Mutex: ID = 0x%08x \"%s\",%s Owner = 0x%x, Locks = %u, Conds = %u, Wq = %zu, Fast = %llu, Contended = %llu, Slept = %llu", id, +name64(mutex.name),
+				mutex.recursive == SYS_SYNC_RECURSIVE ? " Recursive," : "", mutex.owner >> 1, +mutex.lock_count, +mutex.cond_count, mutex.sq.size(),
+				mutex.stats.fast.load(), mutex.stats.contended.load(), mutex.stats.slept.load())));
 			break;
 		}
 		case SYS_COND_OBJECT:
@@ -183,7 +185,7 @@ void kernel_explorer::Update()
 		case SYS_EVENT_QUEUE_OBJECT:
 		{
 			auto& eq = static_cast<lv2_event_queue&>(obj);
-			l_addTreeChild(node, qstr(fmt::format("Event Queue: ID = 0x%08x \"%s\", %s, Key = %#llx, Events = %zu/%d, Waiters = %zu", id, +name64(eq.name),
+			l_addTreeChild(node, qstr(fmt::format("Event Queue: ID = 0x%08x \"%s\", %s, Key = %#llx, Events = %u/%d, Waiters = %zu", id, +name64(eq.name),
 				eq.type == SYS_SPU_QUEUE ? "SPU" : "PPU", eq.key, eq.events.size(), eq.size, eq.sq.size())));
 			break;
 		}
@@ -235,8 +237,8 @@ void kernel_explorer::Update()
 		case SYS_SEMAPHORE_OBJECT:
 		{
 			auto& sema = static_cast<lv2_sema&>(obj);
-			l_addTreeChild(node, qstr(fmt::format("Semaphore: ID = 0x%08x \"%s\", Count = %d, Max Count = %d, Waiters = %#zu", id, +name64(sema.name),
-				sema.val.load(), sema.max, sema.sq.size())));
+			l_addTreeChild(node, qstr(fmt::format("Semaphore: ID = 0x%08x \"%s\", Count = %d, Max Count = %d, Waiters = %#zu, Fast = %llu, Contended = %llu, Slept = %llu", id, +name64(sema.name),
+				sema.val.load(), sema.max, sema.sq.size(), sema.stats.fast.load(), sema.stats.contended.load(), sema.stats.slept.load())));
 			break;
 		}
 		case SYS_LWCOND_OBJECT:
@@ -313,6 +315,24 @@ void kernel_explorer::Update()
 		}
 	}
 
+	if (const u64 direct = lv2_file::g_bytes_direct, copied = lv2_file::g_bytes_copied; direct || copied)
+	{
+		l_addTreeChild(root, qstr(fmt::format("File I/O: Direct = %.3f MB, Copied = %.3f MB", direct / 1048576., copied / 1048576.)));
+	}
+
+	if (ppu_profiler::is_enabled())
+	{
+		const auto profile = ppu_profiler::collect();
+
+		QTreeWidgetItem* node = l_addTreeChild(root, qstr(fmt::format("PPU Call Profile (%zu)", profile.size())));
+
+		for (const auto& e : profile)
+		{
+			l_addTreeChild(node, qstr(fmt::format("%s: Calls = %llu, Total = %.3f ms, Avg = %.3f us, Max = %.3f us, Blocked = %.3f ms", e.name, e.calls,
+				e.total / 1000000., e.total / 1000. / e.calls, e.max / 1000., e.blocked / 1000000.)));
+		}
+	}
+
 	// RawSPU Threads (TODO)
 
 	root->setExpanded(true);